@@ -0,0 +1,91 @@
+#ifndef OBW_CLASS_LAYOUT_H
+#define OBW_CLASS_LAYOUT_H
+
+#include "frontend/Scope.h"
+#include "frontend/parser/Entity.h"
+#include "frontend/types/Decl.h"
+
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @phase Code generation
+ *
+ * Lays out a struct of every class once, fields
+ * of a base class come first, flat:
+ *
+ *   class Animal is              %Animal = { i32, ptr }
+ *     var age : Integer                      age  vptr
+ *     virtual method Speak() ...
+ *   end
+ *   class Dog extends Animal is  %Dog = { i32, ptr, i32 }
+ *     var tricks : Integer                 age  vptr tricks
+ *   end
+ *
+ * so a pointer to a Dog is a pointer to an Animal too,
+ * and an inherited field has the same index in both.
+ * A vptr follows fields of the topmost class with a vtable
+ *
+ * Index, byte offset (by a DataLayout of a target) and
+ * type of each field are kept on a ClassDecl, field access
+ * is one lookup, see ClassDecl::fieldLayout
+ *
+ * Attributes of a class change its own fields only,
+ * a base prefix stays as it is:
+ *
+ *   [reorder]    by alignment, largest first, less padding
+ *   [packed]     no padding at all, taken by subclasses
+ *   [align(N)]   starts and size on N bytes, a cache line
+ *                per object, no false sharing
+ *
+ * @note a base object is never stored whole into a derived
+ * one, fields of a derived class may take its tail padding
+ *
+ * @note a struct is built on first use, classes of other
+ * modules are shared through one LLVMContext (see main.cc)
+ */
+class ClassLayout {
+public:
+  ClassLayout(llvm::LLVMContext &context, const llvm::DataLayout &dataLayout,
+              const std::shared_ptr<Scope<Entity>> &globalScope);
+
+  /**
+   * @return a laid out class, nullptr if there is no
+   * class of that name in a program
+   */
+  ClassDecl *classOf(const std::string &name);
+
+  llvm::StructType *layoutOf(ClassDecl &classDecl);
+
+  /**
+   * [soa] var ps : Array[Point, N]  ->  { [N x i32], [N x i32] }
+   * one array per element of a struct of a class,
+   * paddings take no space there
+   */
+  llvm::StructType *soaOf(ClassDecl &classDecl, uint64_t count);
+
+  // neither a field nor a vptr
+  static bool isPadding(const ClassDecl &classDecl, unsigned index);
+
+  // align(N) of classes in a type, 0 if there is none
+  uint64_t alignOf(const std::shared_ptr<Type> &type);
+
+  // --layout-report, size, padding and offsets of fields
+  void report(const ClassDecl &classDecl, llvm::raw_ostream &out) const;
+
+private:
+  llvm::LLVMContext &context;
+  const llvm::DataLayout &dataLayout;
+  std::unordered_map<std::string, ClassDecl *> classes;
+
+  // a class typed field needs a struct of that class first
+  llvm::Type *lower(const std::shared_ptr<Type> &type);
+};
+
+#endif
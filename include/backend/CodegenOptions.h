@@ -0,0 +1,59 @@
+#ifndef OBW_CODEGEN_OPTIONS_H
+#define OBW_CODEGEN_OPTIONS_H
+
+#include <string>
+
+/**
+ * --overflow=, what a signed Integer add, sub,
+ * mul or negation does when a result does not fit
+ *
+ *   wrap        two's complement, as the constant folder does
+ *   undefined   nsw, optimizer may assume it never happens
+ *   trap        checked, llvm.trap on an overflow, constants
+ *               that overflow are not folded either
+ */
+enum OverflowMode {
+  OVERFLOW_WRAP,
+  OVERFLOW_UNDEFINED,
+  OVERFLOW_TRAP,
+};
+
+/**
+ * --ffast-math[=reassoc,contract,nnan,ninf], flags
+ * put on every Real operation, a method may ask for
+ * them itself by attributes of the same names
+ *
+ *   reassoc    (a + b) + c is a + (b + c), vectorized reductions
+ *   contract   a * b + c is one fma
+ *   nnan ninf  no NaN, no infinity in operands or results
+ *
+ * bare --ffast-math is all of them and the rest of LLVM fast
+ */
+struct FastMath {
+  bool reassoc = false;
+  bool contract = false;
+  bool noNaNs = false;
+  bool noInfs = false;
+  bool fast = false;
+};
+
+/**
+ * @phase Code generation
+ *
+ * Flags of a command line that change what
+ * is generated or printed (see main.cc)
+ */
+struct CodegenOptions {
+  // --layout-report, see ClassLayout
+  bool layoutReport = false;
+  OverflowMode overflow = OVERFLOW_WRAP;
+  // -O0..-O3, a default pipeline of LLVM before
+  // emission, loop hints take effect from -O1
+  unsigned optLevel = 0;
+  FastMath fastMath;
+  // --allocator=, of escaping objects, same
+  // signature as malloc, linked by a user
+  std::string allocator = "malloc";
+};
+
+#endif
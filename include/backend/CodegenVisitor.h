@@ -1,17 +1,22 @@
 #ifndef OBW_CODEGENVISITOR_H
 #define OBW_CODEGENVISITOR_H
 
+#include "backend/ClassLayout.h"
+#include "backend/CodegenOptions.h"
 #include "frontend/SourceManager.h"
 #include "frontend/SymbolTable.h"
 #include "frontend/parser/Statement.h"
 #include "frontend/parser/Visitor.h"
 #include "frontend/parser/Wrappers.h"
+#include "frontend/types/Builtins.h"
 
 #include "llvm/IR/Function.h"
 #include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Intrinsics.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
+#include "llvm/IR/Operator.h"
 #include "llvm/IR/Type.h"
 #include "llvm/IR/Value.h"
 #include "llvm/IR/Verifier.h"
@@ -22,6 +27,7 @@
 #include "llvm/Transforms/Scalar/GVN.h"
 #include "llvm/Transforms/Utils.h"
 #include "llvm/Linker/Linker.h"
+#include "llvm/Passes/PassBuilder.h"
 #include "llvm/IRReader/IRReader.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
@@ -83,16 +89,15 @@ public:
   CodeGenVisitor(
     SourceManager &sm, std::shared_ptr<SourceBuffer> buff,
     const std::shared_ptr<Scope<Entity>> &globalScope,
+                 const std::string &moduleName,
                  const std::shared_ptr<GlobalTypeTable> &typeTable,
-                 std::shared_ptr<llvm::LLVMContext> context)
-      : globalScope(globalScope), typeTable(typeTable), context(context), sm(sm), buff(buff) {
+                 std::shared_ptr<llvm::LLVMContext> context,
+                 const CodegenOptions &options = {})
+      : globalScope(globalScope), typeTable(typeTable), context(context),
+        options(options), moduleName(moduleName), sm(sm), buff(buff) {
     // context = std::make_unique<llvm::LLVMContext>();
     builder = std::make_unique<llvm::IRBuilder<>>(*context);
-
-    auto children = globalScope->getChildren();
-    for (auto child : children) {
-      if (child->getKind() == SCOPE_MODULE) moduleName = child->getName();
-    }
+    builder->setFastMathFlags(fastMathOf(nullptr));
 
     // moduleName = globalScope->getChildren()[0]->getName();
     module = std::make_unique<llvm::Module>(
@@ -103,6 +108,10 @@ public:
     currentScope = globalScope;
     currDepth = 0;
 
+    initTarget();
+    layouts = std::make_unique<ClassLayout>(*context, module->getDataLayout(),
+                                            globalScope);
+
     auto triple = llvm::sys::getDefaultTargetTriple();
     auto ext_std_lib_info_impl = std::make_unique<llvm::TargetLibraryInfoImpl>(
       llvm::Triple(triple));
@@ -228,11 +237,11 @@ public:
   void visit(VarRefEXP &node) override;
   void visit(FieldRefEXP &node) override;
   void visit(MethodCallEXP &node) override;
-  llvm::Value *getSizeOfValue(llvm::Value *value);
   void visit(FuncCallEXP &node) override;
   void visit(ClassNameEXP &node) override;
   void visit(ConversionEXP &node) override;
   void visit(ConstructorCallEXP &node) override;
+  void visit(EnumRefEXP &node) override;
   void visit(CompoundEXP &node) override;
   void visit(ThisEXP &node) override;
   void visit(BinaryOpEXP &node) override;
@@ -265,36 +274,183 @@ public:
   // #####========================================#####
 
   // UNUSED
-  void visit(Block& block) override {};
+  void visit(Block& block) override;
   void visit(EDummy& dummy) override {}
   void visit(EnumDecl& node) override {}
-  void visit(EnumRefEXP& node) override {}
   void visit(UnaryOpEXP &node) override {}
 
   // void visit(Type &node) override;
 
-  void handleBuiltinMethodCall(MethodCallEXP &node,
-                                     std::string methodName);
+  void handleBuiltinMethodCall(MethodCallEXP &node, BuiltinMethod method,
+                               TypeKind receiver);
 
-  void handleIntegerMethods(const std::string &methodName, llvm::Value* L, llvm::Value *R);
+  void handleIntegerMethods(BuiltinMethod method, llvm::Value* L, llvm::Value *R);
 
-  void handleRealMethods(const std::string &methodName, llvm::Value* L, llvm::Value *R);
+  void handleRealMethods(BuiltinMethod method, llvm::Value* L, llvm::Value *R);
 
-  void handleBooleanMethods(const std::string &methodName, llvm::Value* L, llvm::Value *R);
+  void handleBooleanMethods(BuiltinMethod method, llvm::Value* L, llvm::Value *R);
+
+  void handleStringMethods(BuiltinMethod method, llvm::Value *L,
+                           Expression *arg, llvm::Value *R);
 
   void dumpIR() const { module->print(llvm::outs(), nullptr); }
 
+  // a default pipeline of -O1..-O3, missed loop
+  // hints are reported as warnings by it
+  void optimize();
+
   void createObjFile();
 
 private:
   // #####========== UTILLITY ==========#####
+  // triple and DataLayout of a host, set on a module
+  void initTarget();
   llvm::Function *getFunction(std::string name);
   llvm::AllocaInst *createEntryBlockAlloca(llvm::Function *TheFunction,
                                            llvm::Type *Type,
                                            llvm::StringRef VarName);
 
+  // type of a value behind a slot of a variable,
+  // heap objects (see EscapeAnalysis) are no allocas
+  llvm::Type *storedType(llvm::Value *slot, const Entity *decl);
+
+  // storage of a new object, stack unless it escapes,
+  // align is one of align(N) classes (see ClassLayout)
+  llvm::Value *allocateObject(llvm::Type *type, bool escapes,
+                              uint64_t align = 0);
+
+  // signed add, sub or mul by --overflow=, see CodegenOptions,
+  // op is llvm::Intrinsic::s*_with_overflow of it
+  llvm::Value *integerArith(llvm::Intrinsic::ID op, llvm::Value *L,
+                            llvm::Value *R, const llvm::Twine &name);
+
+  // flags of Real operations in a body of decl, options
+  // and its own attributes, see CodegenOptions::fastMath
+  llvm::FastMathFlags fastMathOf(const Decl *decl) const;
+
+  // private unnamed_addr constant of a literal, one per
+  // distinct value, nullptr if an element is no constant
+  llvm::GlobalVariable *constantArray(llvm::ArrayType *type,
+                                      llvm::ArrayRef<llvm::Value *> elements);
+
+  // size of a type by a DataLayout of a target, an i64 constant
+  llvm::ConstantInt *sizeOf(llvm::Type *type);
+  // type a target of an assignment holds
+  llvm::Type *assignedType(AssignmentSTMT &node, llvm::Value *target);
+  // copies a value of type behind src to dst, small ones
+  // as one load and store, larger ones by llvm.memcpy,
+  // an object keeps a vtable of its own class
+  void emitCopy(llvm::Value *dst, llvm::Value *src, llvm::Type *type);
+  // up to that many bytes are copied by load and store
+  static constexpr uint64_t maxLoadStoreCopy = 16;
+
   // creates load instruction to load a pointer type value
   llvm::Value* unwrapPointerReference(Expression *node, llvm::Value *val);
+
+  std::shared_ptr<Type> elementTypeOf(ElementRefEXP &node);
+  // index of an element as i64
+  llvm::Value *indexOf(ElementRefEXP &node);
+  // laid out class of an object a field belongs to
+  ClassDecl *ownerOf(FieldRefEXP &node);
+
+  // type cached on a node by SemanticAnalyzer,
+  // resolved here only for nodes it did not reach
+  std::shared_ptr<Type> typeOf(Expression &node) {
+    return node.resolvedType(typeTable->types[moduleName], currentScope);
+  }
+  // #####========================================#####
+
+  // #####========== STRUCTURE OF ARRAYS ==========#####
+  // see ClassLayout::soaOf for a layout
+
+  // class of elements of a [soa] array, nullptr if it is not one
+  ClassDecl *soaClassOf(const Entity *decl);
+  llvm::Value *soaElement(llvm::Value *soa, llvm::Type *soaType,
+                          unsigned member, llvm::Value *index);
+  // a copy of a whole element, and back
+  llvm::Value *gatherElement(const ClassDecl &classDecl, llvm::Value *soa,
+                             llvm::Type *soaType, llvm::Value *index);
+  void scatterElement(const ClassDecl &classDecl, llvm::Value *soa,
+                      llvm::Type *soaType, llvm::Value *index,
+                      llvm::Value *object);
+  // #####========================================#####
+
+  // #####========== LOCALS ==========#####
+  // every alloca is in an entry block, so a loop runs
+  // in constant stack and mem2reg/SROA see all of them
+
+  // storage of a local or a temporary, alive from here
+  // to an end of the innermost nested block
+  llvm::AllocaInst *localAlloca(llvm::Type *type, const llvm::Twine &name);
+  // parts of an if/loop body, lifetimes of its locals end after it
+  void emitBlock(Block &block);
+  // a ret void, or unreachable if a body falls off its end,
+  // and Strings of a body freed on its returns
+  void emitBodyEnd(bool isVoid);
+  // #####========================================#####
+
+  // #####========== LOOPS ==========#####
+  // preheader -> header (condition) -> body -> latch (step) -> header,
+  // a form LoopSimplify, IndVarSimplify, LICM and a vectorizer expect
+  void emitLoop(Expression &condition, Block *body, Statement *step,
+                const Attributes &hints);
+  // !llvm.loop of a back edge, properties are hints to passes
+  llvm::MDNode *loopMetadata(llvm::ArrayRef<llvm::Metadata *> properties);
+  // [unroll(4)] -> !{"llvm.loop.unroll.count", i32 4}, ...
+  std::vector<llvm::Metadata *> loopHints(const Attributes &hints);
+  // #####========================================#####
+
+  // #####========== SWITCH ==========#####
+  // one LLVM switch, a jump table or a binary search
+  // is picked by a backend from density of labels
+
+  struct SwitchArm {
+    Expression *label; // nullptr for a default
+    Block *body;
+    std::shared_ptr<Scope<Entity>> scope; // of a body
+  };
+  // false, and nothing emitted, if subject is not an integer
+  bool emitSwitch(Expression &subject, const std::vector<SwitchArm> &arms);
+  // if x.Equal(1) ... else if x.Equal(2) ... else ...
+  // as arms of a switch over x, empty for any other chain
+  std::vector<SwitchArm> switchArmsOf(IfSTMT &node);
+  // chains shorter than that stay compares
+  static constexpr size_t minSwitchChain = 3;
+  // #####========================================#####
+
+  // #####========== STRING ==========#####
+  // see runtime/String.h, a String is a pointer to an ObwString
+
+  // a function of the runtime, declared on first use
+  llvm::FunctionCallee stringRuntime(llvm::StringRef name);
+  // { length, capacity, data }, a prefix of an ObwString
+  llvm::StructType *stringHead();
+  // bytes and a length of a String, a literal or an access byte,
+  // runtime takes them as is, so no String is made of a literal
+  std::pair<llvm::Value *, llvm::Value *> stringBytes(Expression &expr,
+                                                      llvm::Value *value);
+  // a String that does not escape, one slot per call site
+  // like an object (see allocateObject), freed on a return
+  void keepString(llvm::Value *string);
+  // frees kept Strings before every return of a function
+  void freeStrings(llvm::Function &function);
+  // #####========================================#####
+
+  // #####========== VIRTUAL DISPATCH ==========#####
+  // see ClassHierarchy for vtables themselves
+
+  const MethodDecl *methodDeclOf(const ClassDecl &classDecl,
+                                 const std::string &name);
+  llvm::GlobalVariable *vtableOf(const ClassDecl &classDecl);
+  // address of a vptr inside an object
+  llvm::Value *vptrOf(llvm::Value *object, const ClassDecl &classDecl);
+  // points a new object to a vtable of its class
+  void initVtable(llvm::Value *object, const ClassDecl &classDecl);
+  // after a copy of a whole object of that type: a subclass
+  // copied into a slot of its base does not keep its vtable
+  void restoreVtable(llvm::Value *object, llvm::Type *type);
+  llvm::Value *loadVirtual(llvm::Value *object, const ClassDecl &classDecl,
+                           int slot);
   // #####========================================#####
 
   // ####=========== GENERICS ==========#####
@@ -312,11 +468,31 @@ private:
   std::shared_ptr<llvm::LLVMContext> context;
   std::unique_ptr<llvm::IRBuilder<>> builder;
   std::unique_ptr<llvm::Module> module;
+  std::unique_ptr<llvm::TargetMachine> targetMachine;
+  // structs and field offsets of classes
+  std::unique_ptr<ClassLayout> layouts;
 
   /// @deprecated use GlobalSymbolTable
   // std::map<std::string, llvm::AllocaInst*> varEnv;
   // std::map<std::string, bool> varInitialized;
 
+  // over it aligned_alloc is called instead
+  static constexpr uint64_t maxMallocAlign = 16;
+
+  CodegenOptions options;
+
+  // locals of nested blocks being emitted, innermost last,
+  // a body of a function has none, it ends with a return
+  std::vector<std::vector<llvm::AllocaInst *>> blockLocals;
+  // slots of keepString in a function being emitted
+  std::vector<llvm::AllocaInst *> stringSlots;
+  // an array literal is used in place, not copied, see visit(VarDecl)
+  bool literalInPlace = false;
+  std::map<llvm::Constant *, llvm::GlobalVariable *> constantArrays;
+  std::map<std::string, llvm::GlobalVariable *> stringLiterals;
+  // loop hints at -O0 are warned about once a module
+  bool warnedHints = false;
+
   std::queue<llvm::Value*> values;
   llvm::Value* lastValue;
   std::shared_ptr<Scope<Entity>> currentScope;
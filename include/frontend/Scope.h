@@ -2,6 +2,7 @@
 #define OBW_SCOPE_H
 
 #include <llvm/IR/Instructions.h>
+#include <algorithm>
 #include <memory>
 #include <stack>
 #include <unordered_map>
@@ -22,10 +23,13 @@ enum ScopeKind {
 template<typename T>
 struct SymbolInfo {
   std::shared_ptr<T> decl; // for parsing phase
-  llvm::AllocaInst* alloca;   // for codegen
+  llvm::Value* alloca;   // for codegen, stack slot or heap object
   bool isInitialized;
 };
 
+template<typename T>
+class ModuleExports;
+
 /**
  * Symbol table for a single scope
  * of a class, method or func
@@ -36,7 +40,7 @@ template<typename T>
 class Scope : public std::enable_shared_from_this<Scope<T>> {
 public:
   Scope(ScopeKind kind, const std::string &name, std::weak_ptr<Scope> parent)
-      : external(false), kind(kind), name(name), parent(parent), depth(-1) {}
+      : external(false), kind(kind), name(name), parent(parent) {}
 
   /**
    * @phase Syntax analysis \n
@@ -56,9 +60,9 @@ public:
    * Puts an allocation intance of a variable into a map
    * with previous Decl set
    * @param name
-   * @param alloca instance of allocation
+   * @param alloca instance of allocation (alloca or malloc)
    */
-  bool addSymbol(const std::string &name, llvm::AllocaInst *alloca) {
+  bool addSymbol(const std::string &name, llvm::Value *alloca) {
     if (!symbols.contains(name))
       return false;
     symbols[name].alloca = alloca;
@@ -82,31 +86,22 @@ public:
   }
 
   /**
-   * Go into the next children scope
-   * @param depth depth of scope relative to the parent
-   *              0 - scope itself
-   * @return children scope at depth
+   * Go back into the parent scope
+   * @return parent scope
    */
-  std::shared_ptr<Scope> nextScope() {
-    depth++;
-    if (depth > static_cast<int>(children.size() - 1)) return std::shared_ptr(parent);
-
-    // skip builtins
-    while (children[depth]->kind >= 7 || children[depth]->external) {
-      depth++;
-    }
-
-    return children[depth];
+  std::shared_ptr<Scope> prevScope() {
+    return std::shared_ptr(parent);
   }
 
   /**
-   * Go into the prev children scope
-   * @param depth depth of scope relative to the parent
-   *              0 - parent scope
-   * @return children scope at depth
+   * @phase Syntax analysis \n
+   * Makes top-level symbols of another module visible
+   * in this scope, importing the same module twice is a no-op
+   * @param exports shared export table of imported module
    */
-  std::shared_ptr<Scope> prevScope() {
-    return std::shared_ptr(parent);
+  void addImport(std::shared_ptr<const ModuleExports<T>> exports) {
+    if (std::ranges::find(imports, exports) == imports.end())
+      imports.push_back(std::move(exports));
   }
 
   template<typename U = T>
@@ -115,6 +110,12 @@ public:
       return reinterpret_cast<SymbolInfo<U>*>(&it->second);
     }
 
+    // then modules imported into this scope
+    for (const auto &imported : imports) {
+      if (auto sym = imported->find(name))
+        return reinterpret_cast<SymbolInfo<U>*>(sym);
+    }
+
     // recursively check parent scopes
     if (auto parent_ptr = parent.lock()) {
       return parent_ptr->template getSymbol<U>(name);
@@ -132,7 +133,7 @@ public:
     return nullptr;
   }
 
-  llvm::AllocaInst* lookupAlloca(const std::string &name) {
+  llvm::Value* lookupAlloca(const std::string &name) {
     if (auto sym = this->getSymbol(name)) return sym->alloca;
     return nullptr;
   }
@@ -151,20 +152,31 @@ public:
       }
     }
     //
-    for (const auto &child : children) {
-      if (child->kind == SCOPE_CLASS && child->name == className) {
-        auto result = child->lookup(name);
-        if (result)
-          return result;
-        return nullptr;
-      }
-    }
+    if (auto child = findChild(SCOPE_CLASS, className))
+      return child->lookup(name);
     // for (const auto &sym : symbols) {
     //   if (sym.second->getKind() == E_Class_Decl)
     // }
     return nullptr;
   }
 
+  /**
+   * Search for a direct children scope,
+   * falling back to top-level scopes of imported modules
+   */
+  std::shared_ptr<Scope> findChild(ScopeKind kind,
+                                   const std::string &name) const {
+    for (const auto &child : children) {
+      if (child->kind == kind && child->name == name)
+        return child;
+    }
+    for (const auto &imported : imports) {
+      if (auto child = imported->findChild(kind, name))
+        return child;
+    }
+    return nullptr;
+  }
+
   // std::shared_ptr<Scope> getModuleScope
   // std::shared_ptr<T>
 
@@ -184,6 +196,7 @@ public:
   std::unordered_map<std::string, SymbolInfo<T>> &getSymbols() {
     return symbols;
   }
+  const auto &getImports() const { return imports; }
 
   void setName(const std::string &name) { this->name = name; }
   void appendToName(const std::string &name) { this->name += name; }
@@ -196,8 +209,74 @@ private:
   std::weak_ptr<Scope> parent;
   std::vector<std::shared_ptr<Scope>> children;
   std::unordered_map<std::string, SymbolInfo<T>> symbols;
+  std::vector<std::shared_ptr<const ModuleExports<T>>> imports;
+};
 
-  int depth;
+/**
+ * Read-only view of the top level of a parsed module.
+ * Created once per module and shared by every module
+ * that imports it, so an import is a pointer instead of
+ * a copy of the exporter's symbols and scopes
+ *
+ * @note imports are transitive, as copies were: if A imports B
+ * and B imports C, names of C are found from A, after those of B
+ */
+template<typename T>
+class ModuleExports {
+public:
+  explicit ModuleExports(std::shared_ptr<Scope<T>> module)
+      : module(std::move(module)) {}
+
+  SymbolInfo<T> *find(const std::string &name) const {
+    std::vector<const ModuleExports *> seen;
+    return find(name, seen);
+  }
+
+  std::shared_ptr<Scope<T>> findChild(ScopeKind kind,
+                                      const std::string &name) const {
+    std::vector<const ModuleExports *> seen;
+    return findChild(kind, name, seen);
+  }
+
+  const std::string &getName() const { return module->getName(); }
+
+private:
+  const std::shared_ptr<Scope<T>> module;
+
+  // modules may import each other, each is searched once
+  SymbolInfo<T> *find(const std::string &name,
+                      std::vector<const ModuleExports *> &seen) const {
+    if (std::ranges::find(seen, this) != seen.end())
+      return nullptr;
+    seen.push_back(this);
+
+    auto &symbols = module->getSymbols();
+    if (auto it = symbols.find(name); it != symbols.end())
+      return &it->second;
+    for (const auto &imported : module->getImports()) {
+      if (auto sym = imported->find(name, seen))
+        return sym;
+    }
+    return nullptr;
+  }
+
+  std::shared_ptr<Scope<T>>
+  findChild(ScopeKind kind, const std::string &name,
+            std::vector<const ModuleExports *> &seen) const {
+    if (std::ranges::find(seen, this) != seen.end())
+      return nullptr;
+    seen.push_back(this);
+
+    for (const auto &child : module->getChildren()) {
+      if (child->getKind() == kind && child->getName() == name)
+        return child;
+    }
+    for (const auto &imported : module->getImports()) {
+      if (auto child = imported->findChild(kind, name, seen))
+        return child;
+    }
+    return nullptr;
+  }
 };
 
 #endif
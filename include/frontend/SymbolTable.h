@@ -24,38 +24,42 @@ public:
     return current_scope;
   }
 
-  // copyying from module to module
+  // importing module into module
   // => globalScope based
-  // @FIXME check if already present
-  void copySymbolFromModulesToCurrent(const std::string &from,
-                                      const std::string &to) {
+  // exporter is shared, not copied, so import is O(1)
+  void importModule(const std::string &from, const std::string &to) {
+    auto exported = getModuleExports(from);
+    if (!exported)
+      throw std::runtime_error("SymbolTable::importModule: No such module " +
+                               from);
 
-    std::unordered_map<std::string, SymbolInfo<Entity>> symbolsToCopy;
-    std::vector<std::shared_ptr<Scope<Entity>>> scopeToCopy;
     for (auto &scope : global_scope->getChildren()) {
-      if (scope->getName() == from) {
-        symbolsToCopy = scope->getSymbols();
-        scopeToCopy = scope->getChildren();
-        break;
+      if (scope->getName() == to) {
+        scope->addImport(exported);
+        return;
       }
     }
 
-    for (auto &scope : global_scope->getChildren()) {
-      if (scope->getName() == to) {
-        for (auto &decl : symbolsToCopy) {
-          scope->addSymbol(decl.first, decl.second.decl);
-        }
-        for (auto &scopeCopy : scopeToCopy) {
-          scopeCopy->external = true;
-          scope->addChild(scopeCopy);
-        }
+    throw std::runtime_error("SymbolTable::importModule: No such module " +
+                             to);
+  }
 
-        return;
+  // export table of a module is created
+  // on first import and reused by every importer after that
+  std::shared_ptr<const ModuleExports<Entity>>
+  getModuleExports(const std::string &name) {
+    if (auto it = exports.find(name); it != exports.end())
+      return it->second;
+
+    for (auto &scope : global_scope->getChildren()) {
+      if (scope->getName() == name) {
+        auto exported = std::make_shared<const ModuleExports<Entity>>(scope);
+        exports.emplace(name, exported);
+        return exported;
       }
     }
 
-    throw std::runtime_error(
-        "SymbolTable::copySymbolFromModulesToCurrent: No such symbol");
+    return nullptr;
   }
 
   // copying from scopd to scope
@@ -65,15 +69,13 @@ public:
                               const std::string &from, const std::string &to,
                               bool doesInherit = false) {
     std::unordered_map<std::string, SymbolInfo<Entity>> symbolsToCopy;
-    std::vector<std::shared_ptr<Scope<Entity>>> scopeToCopy;
-    for (auto scope : sc->getChildren()) {
-      if (scope->getName() == from) {
-        symbolsToCopy = scope->getSymbols();
-        scopeToCopy = scope->getChildren();
-        break;
-      }
+    // base class may come from an imported module
+    if (auto scope = sc->findChild(SCOPE_CLASS, from)) {
+      symbolsToCopy = scope->getSymbols();
     }
 
+    // scopes of methods are not copied, inherited
+    // methods keep the ones of a base class
     for (auto &scope : sc->getChildren()) {
       if (scope->getName() == to) {
         for (auto &decl : symbolsToCopy) {
@@ -82,13 +84,6 @@ public:
               decl.first,
               decl.second.decl);
         }
-        for (auto &scopeCopy : scopeToCopy) {
-          if (scopeCopy->getKind() == SCOPE_METHOD /*@FIXME we can do better than that */ ) {
-            auto _scopeCopy = std::make_shared<Scope<Entity>>(*scopeCopy);
-            _scopeCopy->external = true; // @FIXME marks original as external too
-            scope->addChild(_scopeCopy);
-          }
-        }
 
         return;
       }
@@ -123,6 +118,12 @@ public:
     return current_scope;
   }
 
+  // a class of a template is parsed in a scope of a module,
+  // wherever it is used (see Parser::instantiate)
+  void setCurrentScope(std::shared_ptr<Scope<Entity>> scope) {
+    current_scope = std::move(scope);
+  }
+
   std::shared_ptr<Scope<Entity>>& getCurrentScopeCopy() {
     return current_scope;
   }
@@ -133,6 +134,9 @@ private:
   std::shared_ptr<Scope<Entity>>
       global_scope; // everything is stored in this pointer
   std::shared_ptr<Scope<Entity>> current_scope;
+  // module name -> its shared export table
+  std::unordered_map<std::string, std::shared_ptr<const ModuleExports<Entity>>>
+      exports;
 };
 
 /* @note gavno snizu
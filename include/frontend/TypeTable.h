@@ -5,8 +5,10 @@
 #include "types/Types.h"
 
 #include <algorithm>
+#include <array>
 #include <bits/ranges_algo.h>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -18,10 +20,98 @@ inline std::string str_tolower(std::string s) {
   return s;
 }
 
+/**
+ * Owner of canonical composite types.
+ * Structurally equal access, array, list and function types
+ * are created only once, so two such types are equal
+ * iff they are the same object
+ */
+class TypeInterner {
+public:
+  std::shared_ptr<TypeAccess> getAccessType(const std::shared_ptr<Type> &to) {
+    return intern<TypeAccess>({TYPE_ACCESS, 0, {to.get()}},
+                              [&] { return std::make_shared<TypeAccess>(to); });
+  }
+
+  std::shared_ptr<TypeArray> getArrayType(const std::shared_ptr<Type> &el,
+                                          uint32_t size) {
+    return intern<TypeArray>(
+        {TYPE_ARRAY, size, {el.get()}},
+        [&] { return std::make_shared<TypeArray>(size, el); });
+  }
+
+  std::shared_ptr<TypeList> getListType(const std::shared_ptr<Type> &el) {
+    return intern<TypeList>({TYPE_LIST, 0, {el.get()}},
+                            [&] { return std::make_shared<TypeList>(el); });
+  }
+
+  /**
+   * @param ret nullptr for a function without return type
+   * @param args empty for a function without parameters
+   */
+  std::shared_ptr<TypeFunc>
+  getFuncType(const std::shared_ptr<Type> &ret,
+              const std::vector<std::shared_ptr<Type>> &args) {
+    Key key{TYPE_FUNC, args.size(), {ret.get()}};
+    for (const auto &arg : args)
+      key.parts.push_back(arg.get());
+
+    return intern<TypeFunc>(key, [&] {
+      if (!ret)
+        return args.empty() ? std::make_shared<TypeFunc>()
+                            : std::make_shared<TypeFunc>(args);
+      return args.empty() ? std::make_shared<TypeFunc>(ret)
+                          : std::make_shared<TypeFunc>(ret, args);
+    });
+  }
+
+private:
+  // kind + scalar part (size, arity) + canonical components
+  struct Key {
+    TypeKind kind;
+    uint64_t extra;
+    std::vector<const Type *> parts;
+
+    bool operator==(const Key &) const = default;
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key &key) const {
+      size_t h = std::hash<int>()(key.kind) ^ (key.extra << 8);
+      for (auto part : key.parts)
+        h = h * 31 + std::hash<const Type *>()(part);
+      return h;
+    }
+  };
+
+  template <typename T, typename Create>
+  std::shared_ptr<T> intern(const Key &key, Create create) {
+    // bodies are analyzed concurrently and may intern new types
+    std::lock_guard lock(mutex);
+    if (auto it = canonical.find(key); it != canonical.end())
+      return std::static_pointer_cast<T>(it->second);
+    std::shared_ptr<T> type = create();
+    canonical.emplace(key, type);
+    return type;
+  }
+
+  std::unordered_map<Key, std::shared_ptr<Type>, KeyHash> canonical;
+  std::mutex mutex;
+};
+
 class TypeTable {
 public:
   std::unordered_map<std::string, std::shared_ptr<Type>> types;
 
+  // first registered type of each kind, O(1) lookup by kind
+  std::array<std::shared_ptr<Type>, TYPE_KIND_COUNT> byKind;
+
+  // tables of imported modules, searched after own types
+  std::vector<const TypeTable *> imports;
+
+  // shared by every module of a program
+  std::shared_ptr<TypeInterner> interner;
+
   // Добавление пользовательского типа
   bool addClassType(const std::string &className) {
     if (exists(className)) {
@@ -43,7 +133,7 @@ public:
     if (exists(name)) {
       return false;
     }
-    addType(name, std::make_shared<TypeArray>(size, std::move(elementType)));
+    addType(name, interner->getArrayType(elementType, size));
     return true;
   }
 
@@ -51,7 +141,7 @@ public:
     if (exists(name)) {
       return false;
     }
-    addType(name, std::make_shared<TypeList>(std::move(elementType)));
+    addType(name, interner->getListType(elementType));
     return true;
   }
 
@@ -60,25 +150,41 @@ public:
     if (exists(name)) {
       return false;
     }
-    addType(name,
-            std::make_shared<TypeFunc>(std::move(returnType), std::move(args)));
+    addType(name, interner->getFuncType(returnType, args));
     return true;
   }
 
   void addType(const std::string &name, std::shared_ptr<Type> type) {
+    if (type && type->kind != TYPE_UNKNOWN && !byKind[type->kind])
+      byKind[type->kind] = type;
     types[name] = std::move(type);
   }
 
   std::shared_ptr<Type> getType(const std::string &name) const {
-    auto it = types.find(name);
-    return ((it != types.end()) ? it->second : nullptr);
+    if (auto it = types.find(name); it != types.end())
+      return it->second;
+    for (auto imported : imports) {
+      if (auto type = imported->getType(name))
+        return type;
+    }
+    return nullptr;
   }
 
   std::shared_ptr<Type> getType(TypeKind kind) const {
-    auto type = std::ranges::find_if(
-      types,
-      [&kind](auto pair) { return pair.second->kind == kind; });
-    return (type == types.end()) ? nullptr : type->second;
+    if (kind == TYPE_UNKNOWN)
+      return nullptr;
+    if (byKind[kind])
+      return byKind[kind];
+    for (auto imported : imports) {
+      if (auto type = imported->getType(kind))
+        return type;
+    }
+    return nullptr;
+  }
+
+  void addImport(const TypeTable *table) {
+    if (table != this && std::ranges::find(imports, table) == imports.end())
+      imports.push_back(table);
   }
 
   bool exists(const std::string &name) const { return types.contains(name); }
@@ -97,6 +203,11 @@ public:
 
   // Инициализация встроенных типов
   void initBuiltinTypes() {
+    // builtin types are shared by all modules, create them once
+    if (builtinTypes.interner)
+      return;
+    builtinTypes.interner = interner;
+
     builtinTypes.addType("byte", std::make_shared<TypeByte>());
     // builtinTypes.addType("access", std::make_shared<TypeAccess>());
     builtinTypes.addType("Integer", std::make_shared<TypeInt>());
@@ -109,29 +220,59 @@ public:
     // builtinTypes.addType("Float64", std::make_shared<TypeFloat64>());
     // // builtinTypes.addType("Bool", std::make_shared<TypeBool>());
     builtinTypes.addType("Boolean", std::make_shared<TypeBool>());
-    // builtinTypes.addType("String", std::make_shared<TypeString>());
+    builtinTypes.addType("String", std::make_shared<TypeString>());
     builtinTypes.addType("Opaque", std::make_shared<TypeOpaque>());
     builtinTypes.addType("i64", std::make_shared<TypeInt64>());
     // builtinTypes.addType("Array", std::make_shared<TypeArray>());
   }
 
+  std::shared_ptr<TypeInterner> interner = std::make_shared<TypeInterner>();
   std::unordered_map<std::string, TypeTable> types;
   TypeTable builtinTypes;
 
+  /**
+   * Creates type table of a module
+   * with builtin types visible in it
+   */
+  TypeTable &initModule(const std::string &moduleName) {
+    auto &table = types[moduleName];
+    table.interner = interner;
+    table.addImport(&builtinTypes);
+    return table;
+  }
+
   void addType(const std::string &moduleName, const std::string &typeName,
                std::shared_ptr<Type> type) {
     // auto tName = str_tolower(typeName);
     types[moduleName].addType(typeName, type);
   }
 
+  // importer references exporter's table, nothing is copied
+  // @note unordered_map never moves its values so pointers stay valid
   void importTypesFromModule(const std::string &from, const std::string &to) {
-    auto typesTableFrom = std::ranges::find_if(
-      types,
-      [&from, &to](auto pair) { return pair.first == from; });
+    auto it = types.find(from);
+    if (it == types.end())
+      return;
+    types[to].addImport(&it->second);
+  }
+
+  std::shared_ptr<TypeAccess> getAccessType(const std::shared_ptr<Type> &to) {
+    return interner->getAccessType(to);
+  }
+
+  std::shared_ptr<TypeArray> getArrayType(const std::shared_ptr<Type> &el,
+                                          uint32_t size) {
+    return interner->getArrayType(el, size);
+  }
+
+  std::shared_ptr<TypeList> getListType(const std::shared_ptr<Type> &el) {
+    return interner->getListType(el);
+  }
 
-    std::ranges::for_each(
-      typesTableFrom->second.types,
-      [&to, this](auto pair) { this->types[to].addType(pair.first, pair.second); });
+  std::shared_ptr<TypeFunc>
+  getFuncType(const std::shared_ptr<Type> &ret,
+              const std::vector<std::shared_ptr<Type>> &args) {
+    return interner->getFuncType(ret, args);
   }
 
   std::shared_ptr<Type> getType(const std::string &moduleName,
@@ -158,8 +299,10 @@ public:
    * @return
    */
   std::shared_ptr<Type> getType(const std::string &moduleName, TypeKind kind) {
-    auto it = builtinTypes.getType(kind);
-    if (it) return it;
+    if (auto it = builtinTypes.getType(kind))
+      return it;
+    if (auto it = types.find(moduleName); it != types.end())
+      return it->second.getType(kind);
     return nullptr;
   }
 
@@ -198,6 +198,8 @@ private:
   const char *buffer;
 
   static bool isSpecial(char c);
+  // a character \c in a string literal stands for
+  static char escaped(char c);
 
   void advance() {
     ++curr_column;
@@ -7,7 +7,9 @@
 #include "Visitor.h"
 
 #include <memory>
+#include <optional>
 #include <ostream>
+#include <vector>
 
 #include "frontend/types/Types.h"
 
@@ -19,6 +21,20 @@ struct Loc {
   std::string file;
 };
 
+/**
+ * [name] or [name(N)] in front of a declaration
+ * or a loop, see Parser::parseAttributes
+ *
+ * [packed, align(64)] class Counter is ... end
+ * [unroll(4)] while i.Less(n) loop ... end
+ */
+struct Attribute {
+  std::string name;
+  std::optional<int> value;
+};
+
+using Attributes = std::vector<Attribute>;
+
 /**
  * Describes different kind of
  * entitys available in
@@ -20,10 +20,23 @@ public:
     (void)typeTable;
     return nullptr;
   }
+
+  /**
+   * @brief Type of an expression, resolved only once
+   * @note SemanticAnalyzer fills the cache for every node,
+   * so codegen should not walk scopes again
+   */
+  std::shared_ptr<Type> resolvedType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) {
+    if (!type) type = resolveType(typeTable, currentScope);
+    return type;
+  }
+
   // add evaluate method
   bool validate() override { return false; };
   ~Expression() override;
 
+  std::shared_ptr<Type> type; // set by semantic analyzer
+
   DEFINE_VISITABLE()
 };
 
@@ -45,19 +58,19 @@ public:
  */
 class IntLiteralEXP : public Expression {
 public:
-  IntLiteralEXP(int val, size_t bytesize)
+  IntLiteralEXP(int64_t val, size_t bytesize)
     : Expression(E_Integer_Literal, std::to_string(val)), bytesize(bytesize), _value(val) {};
 
   size_t getByteSize() const { return bytesize; };
-  int getValue() const { return _value; }
+  int64_t getValue() const { return _value; }
 
   std::shared_ptr<Type> resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) override;
 
   DEFINE_VISITABLE()
 
 private:
-  size_t bytesize;
-  int _value;
+  size_t bytesize; // in bits
+  int64_t _value;
 };
 
 class RealLiteralEXP : public Expression {
@@ -65,7 +78,7 @@ public:
   RealLiteralEXP(double val)
     : Expression(E_Real_Literal, std::to_string(val)), _value(val) {};
 
-  double getValue() { return _value; }
+  double getValue() const { return _value; }
 
   std::shared_ptr<Type> resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) override;
 
@@ -78,13 +91,9 @@ private:
 class StringLiteralEXP : public Expression {
 public:
   StringLiteralEXP(std::string val)
-      : Expression(E_String_Literal), value(std::move(val)) {
-     value.erase(
-     std::remove(value.begin(), value.end(), '\"'),
-     value.end()
-     );
-  };
+      : Expression(E_String_Literal), value(std::move(val)) {};
 
+  // escapes replaced and no quotes, see Lexer
   std::string value;
 
   std::shared_ptr<Type> resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) override;
@@ -184,6 +193,8 @@ public:
   std::shared_ptr<VarRefEXP> arr;
   std::shared_ptr<Expression> index;
 
+  std::shared_ptr<Type> resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) override;
+
   DEFINE_VISITABLE()
 };
 
@@ -246,6 +257,9 @@ public:
   // children should be
   std::shared_ptr<Expression> left;
   std::vector<std::shared_ptr<Expression>> arguments;
+  // slot of a vtable to call through, -1 for a direct call
+  // (set by SemanticAnalyzer, see ClassHierarchy)
+  int vtableIndex = -1;
 
   std::shared_ptr<Type> resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) override;
   bool validate() override;
@@ -323,17 +337,18 @@ public:
   ConstructorCallEXP(std::shared_ptr<ClassNameEXP> left,
                      std::vector<std::shared_ptr<Expression>> arguments)
       : Expression(E_Constructor_Call), left(std::move(left)),
-        arguments(std::move(arguments)), isDefault(false) {};
+        arguments(std::move(arguments)), isDefault(false), escapes(false) {};
 
   // Default constr
   ConstructorCallEXP(std::shared_ptr<ClassNameEXP> left)
       : Expression(E_Constructor_Call), left(std::move(left)), arguments(),
-        isDefault(true) {};
+        isDefault(true), escapes(false) {};
 
   // children should be
   std::shared_ptr<ClassNameEXP> left;
   std::vector<std::shared_ptr<Expression>> arguments;
   bool isDefault;
+  bool escapes; // set by EscapeAnalysis, heap if true
 
   std::shared_ptr<Type> resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) override;
 
@@ -476,13 +491,18 @@ public:
 class EnumRefEXP : public Expression {
 public:
   EnumRefEXP(const std::string &enumName, const std::string &itemName)
-      : Expression(E_Enum_Reference, itemName), enumName(enumName) {};
+      : Expression(E_Enum_Reference, itemName), enumName(enumName),
+        itemName(itemName) {};
 
+  // `CMD` of `CMD::PLUS`, see Parser::parseStaticAccess
   EnumRefEXP(const std::string &enumName)
       : Expression(E_Enum_Reference), enumName(enumName) {};
   std::string enumName;
   std::string itemName;
 
+  // an item is its number, an Integer
+  std::shared_ptr<Type> resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) override;
+
   DEFINE_VISITABLE()
 };
 
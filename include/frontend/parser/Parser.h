@@ -14,6 +14,7 @@
 #include <optional>
 #include <stack>
 #include <stdexcept>
+#include <unordered_map>
 
 class Parser {
   std::shared_ptr<SymbolTable> globalSymbolTable;
@@ -99,6 +100,34 @@ private:
 
   std::shared_ptr<ClassDecl> parseClassDecl();
 
+  /**
+   * @note GenericClass ::= \n
+   * "class" Identifier "[" Identifier { "," Identifier } "]" ... "end"
+   *
+   * Only an end of a body is found, it is parsed per
+   * instance, see TypeGenericClass
+   * @param start position of `class`
+   */
+  void parseGenericClass(int start, const std::string &name);
+
+  /**
+   * A class of a template for arguments, parsed once per module:
+   * tokens of a template are replayed with its parameters
+   * bound to arguments in a type table of a module
+   *
+   * @return nullptr if a body does not parse for them
+   */
+  std::shared_ptr<Type>
+  instantiate(const std::shared_ptr<TypeGenericClass> &generic,
+              const std::vector<std::shared_ptr<Type>> &args);
+
+  /**
+   * @note Attributes ::= \n
+   * "[" Identifier [ "(" Integer ")" ] { "," ... } "]"
+   *
+   */
+  Attributes parseAttributes();
+
   std::shared_ptr<FieldDecl> parseFieldDecl(size_t index = 0);
 
   /**
@@ -152,6 +181,26 @@ private:
    */
   std::shared_ptr<ParameterDecl> parseParameterDecl();
 
+  /**
+   * ReturnType
+   *   : Identifier
+   *   | access Identifier
+   *   | Array [ Identifier , IntegerLiteral ]
+   *
+   * @param token already eaten first token of a type
+   */
+  std::shared_ptr<Type> parseReturnType(const Token &token);
+
+  /**
+   * TypeName
+   *   : Identifier
+   *   | Identifier [ TypeName { , TypeName } ]
+   *
+   * an instance if a name is one of a template
+   * @param token already eaten name of a type
+   */
+  std::shared_ptr<Type> parseTypeName(const Token &token);
+
   /**
    *
    */
@@ -212,6 +261,15 @@ private:
 
   std::string moduleName;
 
+  // parameters of a template an instance of it
+  // is parsed for, bound to arguments
+  std::unordered_map<std::string, std::shared_ptr<Type>> typeArguments;
+  // set while a template is replayed, a name of its instance
+  std::optional<std::string> instanceName;
+  // classes made while a declaration was parsed, a module
+  // gets them before it, a class comes before its uses
+  std::vector<std::shared_ptr<ClassDecl>> instances;
+
   OperatorKind tokenToOperator(TokenKind kind);
 
   SourceManager &sm;
@@ -156,6 +156,7 @@ public:
   std::shared_ptr<Block> ifTrue;
   std::shared_ptr<Entity> ifFalse;
   bool isElsed;
+  std::shared_ptr<Scope<Entity>> scope; // set by parser
 
   ~IfSTMT() override = default;
 
@@ -228,6 +229,8 @@ public:
 
   std::shared_ptr<Expression> condition;
   std::shared_ptr<Block> body;
+  std::shared_ptr<Scope<Entity>> scope; // set by parser
+  Attributes hints; // [unroll(4)] ..., see CodeGenVisitor::loopHints
 
   ~WhileSTMT() override = default;
 
@@ -252,6 +255,8 @@ public:
   std::shared_ptr<Expression> condition;
   std::shared_ptr<AssignmentSTMT> post;
   std::shared_ptr<Block> body;
+  std::shared_ptr<Scope<Entity>> scope; // set by parser
+  Attributes hints;
 
   ~ForSTMT() override = default;
 
@@ -0,0 +1,81 @@
+#ifndef OBW_CLASS_HIERARCHY_H
+#define OBW_CLASS_HIERARCHY_H
+
+#include "frontend/Scope.h"
+#include "frontend/parser/Entity.h"
+#include "frontend/types/Decl.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @phase Semantic analysis
+ *
+ * Classes of every module of a program, their
+ * virtual tables and overriders (CHA):
+ *
+ *   class Animal is
+ *     virtual method Speak() ...    // slot 0 -> Animal_Speak
+ *   end
+ *   class Dog extends Animal is
+ *     override method Speak() ...   // slot 0 -> Dog_Speak
+ *   end
+ *
+ *   a.Speak()   // a : access Animal, Dog overrides -> vtable
+ *   d.Speak()   // d : access Dog, nothing below    -> Dog_Speak()
+ *
+ * A slot keeps its index down a hierarchy, so a vtable
+ * of a derived class starts with the one of its base.
+ * A call is devirtualized when every class that may be
+ * behind a static type of a receiver shares one
+ * implementation of a slot
+ *
+ * @note closed world, built once every module of
+ * a program is parsed (see main.cc)
+ */
+class ClassHierarchy {
+public:
+  explicit ClassHierarchy(const std::shared_ptr<Scope<Entity>> &globalScope);
+
+  ClassDecl *classOf(const std::string &name) const;
+
+  /**
+   * @return index of `method` (not mangled) in a vtable
+   * of a class, -1 if it is not virtual
+   */
+  int slotOf(const ClassDecl &classDecl, const std::string &method) const;
+
+  /**
+   * @return a slot to call `method` through,
+   * -1 if a call has one target and can be direct
+   */
+  int dispatch(const ClassDecl &classDecl, const std::string &method) const;
+
+  // every method a call through a slot may run, own one first
+  std::vector<const MethodDecl *> implementations(const ClassDecl &classDecl,
+                                                  size_t slot) const;
+
+  // `override` of nothing or with another signature
+  std::vector<std::string> check(const ModuleDecl &module) const;
+
+  // unmangled name of a method, Dog_Speak -> Speak
+  static std::string methodName(const ClassDecl &classDecl,
+                                const Decl &method);
+
+private:
+  std::unordered_map<std::string, ClassDecl *> classes;
+  std::unordered_map<const ClassDecl *, std::vector<const ClassDecl *>>
+      subclasses;
+  // slot -> method that implements it, inherited copies
+  // lead to an original one of a base class
+  std::unordered_map<const ClassDecl *, std::vector<const MethodDecl *>>
+      origins;
+
+  void build(ClassDecl &classDecl);
+  void collectOrigins(const ClassDecl &classDecl, size_t slot,
+                      std::vector<const MethodDecl *> &result) const;
+};
+
+#endif
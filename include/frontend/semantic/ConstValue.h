@@ -0,0 +1,81 @@
+#ifndef OBW_CONST_VALUE_H
+#define OBW_CONST_VALUE_H
+
+#include "frontend/parser/Expression.h"
+#include "frontend/types/Builtins.h"
+#include "frontend/types/Types.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+/**
+ * @phase Semantic analysis
+ *
+ * Value known at compile time, shared by
+ * ConstantFolder and Interpreter, so both
+ * agree with codegen on what an operation yields
+ *
+ * Integers keep a width in bits (8/16/32/64)
+ * and wrap around at it, as LLVM add/sub/mul do,
+ * unless an overflow traps (--overflow=trap), then
+ * an overflowing operation is left to runtime
+ */
+struct ConstValue {
+  enum Kind {
+    CV_UNSET, // declared, never written
+    CV_INT,
+    CV_REAL,
+    CV_BOOL,
+    CV_ARRAY,
+  };
+
+  Kind kind = CV_UNSET;
+  int64_t i = 0;
+  size_t bits = 32;
+  double r = 0;
+  bool b = false;
+  std::vector<ConstValue> elements;
+
+  static ConstValue ofInt(int64_t value, size_t bits);
+  static ConstValue ofReal(double value);
+  static ConstValue ofBool(bool value);
+  static ConstValue ofArray(std::vector<ConstValue> elements);
+
+  bool operator==(const ConstValue &other) const = default;
+};
+
+/**
+ * @return value of an Integer, Real or Boolean literal
+ * (or an array literal of those), nullopt for anything else
+ */
+std::optional<ConstValue> literalValue(const Expression &expr);
+
+/**
+ * @brief a.Plus(b), a.Less(b), a.UnaryMinus() ...
+ * @param arg nullptr for unary methods
+ * @param wraps false if an Integer overflow traps
+ * @return nullopt if it can not (or must not) be done
+ * at compile time, e.g. division by zero
+ */
+std::optional<ConstValue> evalBuiltin(BuiltinMethod method,
+                                      const ConstValue &self,
+                                      const ConstValue *arg,
+                                      bool wraps = true);
+std::optional<ConstValue> evalBinary(OperatorKind op, const ConstValue &left,
+                                     const ConstValue &right,
+                                     bool wraps = true);
+std::optional<ConstValue> evalUnary(OperatorKind op,
+                                    const ConstValue &operand,
+                                    bool wraps = true);
+std::optional<ConstValue> evalConversion(const ConstValue &from,
+                                         const Type &to);
+
+/**
+ * @brief Value stored to a variable of type `to`,
+ * integers are wrapped to its width
+ * @return nullopt if value does not fit a type at all
+ */
+std::optional<ConstValue> coerce(const ConstValue &value, const Type &to);
+
+#endif
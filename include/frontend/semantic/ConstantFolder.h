@@ -0,0 +1,94 @@
+#ifndef OBW_CONSTANT_FOLDER_H
+#define OBW_CONSTANT_FOLDER_H
+
+#include "frontend/TypeTable.h"
+#include "frontend/parser/Entity.h"
+#include "frontend/parser/Expression.h"
+#include "frontend/parser/Statement.h"
+#include "frontend/parser/Wrappers.h"
+#include "frontend/semantic/ConstValue.h"
+#include "frontend/semantic/Interpreter.h"
+#include "frontend/types/Decl.h"
+
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+/**
+ * @phase Semantic analysis
+ *
+ * Folds builtin Integer/i64/Real/Boolean operations
+ * with constant operands into literals:
+ *
+ *   5.Plus(3).Mult(2)  ->  16
+ *   -(2)               ->  -2
+ *   3.5 as Integer     ->  3
+ *
+ * Integers wrap around at the width of a literal,
+ * the same way LLVM add/sub/mul do. Division by zero and
+ * MIN / -1 are left to runtime.
+ *
+ * Local `var`s initialized with a constant and never
+ * assigned afterwards are propagated into their uses.
+ *
+ * Given an Interpreter, calls of pure functions with
+ * constant arguments are replaced with their results,
+ * an Array result only as an initializer of a `var`,
+ * where codegen makes it a constant global
+ *
+ * @note runs after types are cached (see SemanticAnalyzer),
+ * replacement nodes get the type of a node they replace
+ */
+class ConstantFolder {
+public:
+  // wraps: false if an Integer overflow traps at runtime
+  ConstantFolder(const TypeTable &typeTable,
+                 std::shared_ptr<Scope<Entity>> scope,
+                 Interpreter *interpreter = nullptr, bool wraps = true)
+      : typeTable(typeTable), currentScope(std::move(scope)),
+        interpreter(interpreter), wraps(wraps) {}
+
+  /**
+   * @brief Folds a body of method, constructor or function
+   */
+  void foldBody(Decl &decl);
+
+  /**
+   * @brief Folds a single expression, no propagation
+   * @return folded replacement or expr itself
+   */
+  std::shared_ptr<Expression> fold(const std::shared_ptr<Expression> &expr);
+
+private:
+  const TypeTable &typeTable;
+  std::shared_ptr<Scope<Entity>> currentScope;
+  Interpreter *interpreter;
+  bool wraps;
+
+  // locals that are assigned somewhere in a body
+  std::unordered_set<const Entity *> assigned;
+  // locals known to hold a constant
+  std::unordered_map<const Entity *, std::shared_ptr<Expression>> constants;
+
+  void collectAssigned(const std::shared_ptr<Entity> &entity);
+  void foldEntity(const std::shared_ptr<Entity> &entity);
+  void foldBlock(const std::shared_ptr<Block> &block);
+
+  const Entity *declOf(const std::string &name);
+
+  std::shared_ptr<Expression> foldMethodCall(MethodCallEXP &node);
+  std::shared_ptr<Expression> foldBinaryOp(BinaryOpEXP &node);
+  std::shared_ptr<Expression> foldUnaryOp(UnaryOpEXP &node);
+  std::shared_ptr<Expression> foldConversion(ConversionEXP &node);
+  std::shared_ptr<Expression> foldCall(Expression &node, bool allowArray);
+
+  // copy of a literal, so that every use is a node of its own
+  std::shared_ptr<Expression> copyLiteral(const Expression &literal);
+  std::shared_ptr<Expression> makeLiteral(const ConstValue &value,
+                                          const std::shared_ptr<Type> &type);
+  // literal that takes place of `replaced`, nullptr if no value
+  std::shared_ptr<Expression> makeLiteral(const std::optional<ConstValue> &value,
+                                          const Expression &replaced);
+};
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef OBW_ESCAPE_ANALYSIS_H
+#define OBW_ESCAPE_ANALYSIS_H
+
+#include "frontend/parser/Entity.h"
+#include "frontend/parser/Expression.h"
+#include "frontend/parser/Statement.h"
+#include "frontend/parser/Wrappers.h"
+#include "frontend/semantic/ClassHierarchy.h"
+#include "frontend/types/Decl.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @phase Semantic analysis
+ *
+ * Finds objects that may outlive a call of
+ * the function they are constructed in:
+ *
+ *   func make() : access Point is
+ *     return Point(1, 2)           // escapes -> heap
+ *   end
+ *
+ *   var p : Point := Point(1, 2)   // stays   -> stack
+ *   p.Print()
+ *
+ * Objects flow between constructor calls, locals
+ * and parameters, calls link arguments to parameters
+ * of a callee, so this is a graph over the whole module.
+ * An object escapes if it may reach a `return`, a field,
+ * an array element or a module variable of an `access`
+ * type, or a callee we know nothing about. Escaping
+ * spreads back along the flow
+ *
+ * Class typed locals, fields and returns copy
+ * a value, so they do not keep an object alive
+ *
+ * @note `this` is one ParameterDecl per class (see Parser),
+ * so a method that leaks `this` makes every receiver of
+ * that class escape. Conservative, never wrong
+ *
+ * @note an object constructed in a loop and kept in an
+ * `access` local escapes too: one stack slot per call
+ * site can not hold objects of two iterations at once
+ *
+ * @note a call through a vtable links its arguments to
+ * every overrider of a slot, see ClassHierarchy
+ *
+ * @note a String is a ConstructorCallEXP too, its locals hold
+ * a pointer like `access` ones do. One that stays is freed
+ * when its function returns (see CodeGenVisitor)
+ */
+class EscapeAnalysis {
+public:
+  // without a hierarchy, dispatched calls are unknown callees
+  explicit EscapeAnalysis(const ModuleDecl &module,
+                          const ClassHierarchy *hierarchy = nullptr);
+
+  // sets ConstructorCallEXP::escapes of every object in a module
+  void analyze();
+
+private:
+  // where a value of an expression goes
+  struct Sink {
+    enum Kind {
+      SINK_DISCARD, // read, compared, dropped
+      SINK_COPY,    // copied by value
+      SINK_ESCAPE,  // outlives a call
+      SINK_FLOW,    // into a local or a parameter
+    } kind;
+    const Entity *to = nullptr;
+  };
+
+  const ModuleDecl &module;
+  const ClassHierarchy *hierarchy;
+
+  struct Callee {
+    const std::vector<std::shared_ptr<ParameterDecl>> *args;
+    std::shared_ptr<Scope<Entity>> scope;
+  };
+
+  // everything with a body in this module
+  std::unordered_map<const Decl *, Callee> callees;
+  std::unordered_set<const Entity *> globals;
+
+  // reversed edges, where does a value come from
+  std::unordered_map<const Entity *, std::vector<const Entity *>> sources;
+  std::unordered_set<const Entity *> escaping;
+  std::vector<ConstructorCallEXP *> objects;
+
+  std::shared_ptr<Scope<Entity>> currentScope;
+  std::shared_ptr<Type> returnType;
+  size_t loopDepth = 0;
+
+  const Entity *declOf(const std::string &name);
+  const ClassDecl *classOf(const std::string &name);
+  const Decl *methodOf(const MethodCallEXP &call);
+  // overriders of a dispatched call, empty for a direct one
+  std::vector<const Decl *> overridersOf(const MethodCallEXP &call);
+  const Decl *constructorOf(const ConstructorCallEXP &call);
+  bool isDefault(const ConstructorCallEXP &call);
+  bool isLocal(const Entity *decl) const;
+
+  void walkBody(const std::shared_ptr<Block> &body,
+                const std::shared_ptr<Scope<Entity>> &scope,
+                const std::shared_ptr<TypeFunc> &signature);
+  void walk(const std::shared_ptr<Entity> &entity);
+  void use(const std::shared_ptr<Expression> &expr, Sink sink);
+  void arguments(const std::vector<std::shared_ptr<Expression>> &args,
+                 const Decl *callee, size_t firstParam);
+  // a value passed to one of callees, it escapes
+  // if any of them lets it escape
+  void passed(const std::shared_ptr<Expression> &value,
+              const std::vector<const Decl *> &callees, size_t param);
+  void flow(const Entity *from, Sink sink, bool byValue);
+
+  // into a slot of a given type: a field, an element, a global...
+  static Sink storeTo(const Type *type);
+  Sink paramOf(const Decl *callee, size_t index) const;
+
+  void propagate();
+
+  static bool isReference(const Type *type);
+  static const Type *declaredType(const Entity *decl);
+};
+
+#endif
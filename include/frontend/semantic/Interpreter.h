@@ -0,0 +1,112 @@
+#ifndef OBW_INTERPRETER_H
+#define OBW_INTERPRETER_H
+
+#include "frontend/parser/Entity.h"
+#include "frontend/parser/Expression.h"
+#include "frontend/parser/Statement.h"
+#include "frontend/parser/Wrappers.h"
+#include "frontend/semantic/ConstValue.h"
+#include "frontend/types/Decl.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @phase Semantic analysis
+ *
+ * Evaluates calls of pure functions with constant
+ * arguments at compile time (CTFE):
+ *
+ *   func fib(n : Integer) : Integer is ... end
+ *
+ *   var a : Integer := fib(20)         ->  6765
+ *   var b : Integer := Math::sq(3)     ->  9
+ *
+ * A `func` (or a static method) is pure if it only reads
+ * and writes its parameters and locals, and calls nothing
+ * but builtin operations and other pure functions.
+ * Purity is found over a call graph of a module, so
+ * (mutual) recursion is fine
+ *
+ * Evaluation is bounded by `maxSteps` and `maxDepth`,
+ * a call that runs out of either, or would trap at runtime
+ * (division by zero, out of bounds index, reading an
+ * uninitialized local...) is left to runtime as is
+ *
+ * @note expects typed and folded bodies (see SemanticAnalyzer),
+ * results of pure calls are memoized, so the likes
+ * of naive fibonacci stay linear
+ */
+class Interpreter {
+public:
+  static constexpr size_t maxSteps = 1 << 20;
+  static constexpr size_t maxDepth = 256;
+
+  // wraps: false if an Integer overflow traps at runtime
+  explicit Interpreter(const ModuleDecl &module, bool wraps = true);
+
+  bool hasPureFunctions() const { return !pure.empty(); }
+
+  /**
+   * @brief Evaluates a FuncCallEXP or a static MethodCallEXP
+   * @return nullopt if callee is not pure, some argument
+   * is not a literal or evaluation gave up
+   */
+  std::optional<ConstValue> evaluate(const Expression &call,
+                                     const std::shared_ptr<Scope<Entity>> &scope);
+
+private:
+  struct Function {
+    const std::vector<std::shared_ptr<ParameterDecl>> *args;
+    size_t firstArg; // 1 to skip `this` of a static method
+    std::shared_ptr<Block> body;
+    std::shared_ptr<Scope<Entity>> scope;
+    std::shared_ptr<Type> returnType;
+  };
+
+  // thrown to abandon an evaluation
+  struct GiveUp {};
+
+  enum Flow { FLOW_NEXT, FLOW_RETURN };
+
+  // functions with a body that return a value
+  std::unordered_map<const Decl *, Function> functions;
+  std::unordered_set<const Decl *> pure;
+  // module level variables, may change at runtime
+  std::unordered_set<const Entity *> globals;
+  std::unordered_map<std::string, ConstValue> memo;
+  bool wraps;
+
+  std::shared_ptr<Scope<Entity>> currentScope;
+  std::unordered_map<const Entity *, ConstValue> *locals = nullptr;
+  ConstValue returned;
+  size_t steps = 0;
+  size_t depth = 0;
+
+  const Entity *declOf(const std::string &name);
+  const Decl *calleeOf(const Expression &call);
+
+  // purity
+  void findPure();
+  bool isPure(const std::shared_ptr<Entity> &entity);
+  bool isLocal(const std::string &name);
+
+  // evaluation
+  ConstValue call(const Decl *callee, const std::vector<ConstValue> &args);
+  Flow exec(const std::shared_ptr<Entity> &entity);
+  Flow execBlock(const std::shared_ptr<Block> &block);
+  ConstValue eval(const std::shared_ptr<Expression> &expr);
+  ConstValue &localOf(const std::string &name);
+  ConstValue &elementOf(const ElementRefEXP &element);
+  void step();
+
+  // give up unless value is there
+  static ConstValue expect(const std::optional<ConstValue> &value);
+  static const Type *declaredType(const Entity *decl);
+};
+
+#endif
@@ -4,33 +4,196 @@
 #include "frontend/SymbolTable.h"
 #include "frontend/TypeTable.h"
 #include "frontend/parser/Entity.h"
+#include "frontend/parser/Expression.h"
+#include "frontend/parser/Statement.h"
+#include "frontend/parser/Wrappers.h"
+#include "frontend/semantic/ClassHierarchy.h"
+#include "frontend/types/Decl.h"
+
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
-/*
-class SemanticAnalyzer {
+/**
+ * @phase Semantic analysis
+ *
+ * Walks a parsed module and resolves type
+ * of every expression once, caching it on a node
+ * (see Expression::type), so codegen does not
+ * have to walk scopes again
+ *
+ * Runs in three phases (see docs/notes.md):
+ *   1. signatures   - fields, parameters and return types,
+ *                     overrides (see ClassHierarchy)
+ *   2. initializers - module level variables
+ *   3. bodies       - methods, constructors and functions,
+ *                     concurrently on a thread pool
+ *
+ * then two passes over checked bodies, on one thread:
+ *   - evaluation    - calls of pure functions with
+ *                     constant arguments (see Interpreter)
+ *   - escapes       - objects that outlive a function,
+ *                     heap or stack (see EscapeAnalysis)
+ *
+ * Once typed, expressions with constant operands
+ * are folded (see ConstantFolder), and calls of virtual
+ * methods get a vtable slot unless devirtualized
+ *
+ * @note after phases 1-2 class and signature tables are
+ * frozen, bodies only read them and write types on their
+ * own nodes, so each body gets a visitor of its own
+ */
+class SemanticAnalyzer : public BaseVisitor,
+                         public Visitor<Entity, void>,
+                         public Visitor<EDummy, void>,
+                         public Visitor<Statement, void>,
+                         public Visitor<AssignmentSTMT, void>,
+                         public Visitor<ReturnSTMT, void>,
+                         public Visitor<IfSTMT, void>,
+                         public Visitor<CaseSTMT, void>,
+                         public Visitor<SwitchSTMT, void>,
+                         public Visitor<WhileSTMT, void>,
+                         public Visitor<ForSTMT, void>,
+                         public Visitor<Expression, void>,
+                         public Visitor<IntLiteralEXP, void>,
+                         public Visitor<RealLiteralEXP, void>,
+                         public Visitor<StringLiteralEXP, void>,
+                         public Visitor<BoolLiteralEXP, void>,
+                         public Visitor<NilLiteralEXP, void>,
+                         public Visitor<ArrayLiteralExpr, void>,
+                         public Visitor<VarRefEXP, void>,
+                         public Visitor<FieldRefEXP, void>,
+                         public Visitor<ElementRefEXP, void>,
+                         public Visitor<MethodCallEXP, void>,
+                         public Visitor<FuncCallEXP, void>,
+                         public Visitor<ClassNameEXP, void>,
+                         public Visitor<ConstructorCallEXP, void>,
+                         public Visitor<CompoundEXP, void>,
+                         public Visitor<ThisEXP, void>,
+                         public Visitor<ConversionEXP, void>,
+                         public Visitor<BinaryOpEXP, void>,
+                         public Visitor<UnaryOpEXP, void>,
+                         public Visitor<EnumRefEXP, void>,
+                         public Visitor<AssignmentWrapperEXP, void>,
+                         public Visitor<Decl, void>,
+                         public Visitor<FieldDecl, void>,
+                         public Visitor<VarDecl, void>,
+                         public Visitor<ParameterDecl, void>,
+                         public Visitor<MethodDecl, void>,
+                         public Visitor<ConstrDecl, void>,
+                         public Visitor<FuncDecl, void>,
+                         public Visitor<ClassDecl, void>,
+                         public Visitor<ModuleDecl, void>,
+                         public Visitor<EnumDecl, void> {
 public:
+  // wrapsOverflow: false under --overflow=trap, an Integer
+  // operation that overflows is then not folded
   SemanticAnalyzer(std::shared_ptr<GlobalTypeTable> globalTypeTable,
-                   std::shared_ptr<SymbolTable> symbolTable)
-      : globalTypeTable(globalTypeTable), symbolTable(symbolTable) {}
+                   std::shared_ptr<SymbolTable> symbolTable,
+                   bool wrapsOverflow = true)
+      : globalTypeTable(std::move(globalTypeTable)),
+        symbolTable(std::move(symbolTable)), moduleTypes(nullptr),
+        wrapsOverflow(wrapsOverflow) {}
 
-  bool analyze(std::shared_ptr<Entity> root);
+  /**
+   * @brief Annotates every expression of a module with its type
+   * @return false if there were semantic errors
+   */
+  bool analyze(const std::shared_ptr<ModuleDecl> &module);
   const std::vector<std::string> &getErrors() const { return errors; }
 
+  void visit(Entity &node) override {}
+  void visit(EDummy &node) override {}
+  void visit(Statement &node) override {}
+  void visit(AssignmentSTMT &node) override;
+  void visit(ReturnSTMT &node) override;
+  void visit(IfSTMT &node) override;
+  void visit(CaseSTMT &node) override;
+  void visit(SwitchSTMT &node) override;
+  void visit(WhileSTMT &node) override;
+  void visit(ForSTMT &node) override;
+
+  void visit(Expression &node) override { annotate(node); }
+  void visit(IntLiteralEXP &node) override { annotate(node); }
+  void visit(RealLiteralEXP &node) override { annotate(node); }
+  void visit(StringLiteralEXP &node) override { annotate(node); }
+  void visit(BoolLiteralEXP &node) override { annotate(node); }
+  void visit(NilLiteralEXP &node) override { annotate(node); }
+  void visit(ArrayLiteralExpr &node) override;
+  void visit(VarRefEXP &node) override;
+  void visit(FieldRefEXP &node) override;
+  void visit(ElementRefEXP &node) override;
+  void visit(MethodCallEXP &node) override;
+  void visit(FuncCallEXP &node) override;
+  void visit(ClassNameEXP &node) override { annotate(node); }
+  void visit(ConstructorCallEXP &node) override;
+  void visit(CompoundEXP &node) override;
+  void visit(ThisEXP &node) override { annotate(node); }
+  void visit(ConversionEXP &node) override;
+  void visit(BinaryOpEXP &node) override;
+  void visit(UnaryOpEXP &node) override;
+  void visit(EnumRefEXP &node) override;
+  void visit(AssignmentWrapperEXP &node) override;
+
+  void visit(Decl &node) override {}
+  void visit(FieldDecl &node) override {}
+  void visit(VarDecl &node) override;
+  void visit(ParameterDecl &node) override {}
+  void visit(MethodDecl &node) override;
+  void visit(ConstrDecl &node) override;
+  void visit(FuncDecl &node) override;
+  void visit(ClassDecl &node) override;
+  void visit(ModuleDecl &node) override;
+  void visit(EnumDecl &node) override {}
+
 private:
   std::shared_ptr<GlobalTypeTable> globalTypeTable;
   std::shared_ptr<SymbolTable> symbolTable;
+
+  const TypeTable *moduleTypes;
+  bool wrapsOverflow;
+  std::shared_ptr<const ClassHierarchy> hierarchy;
+  std::shared_ptr<Scope<Entity>> currentScope;
   std::vector<std::string> errors;
-  std::shared_ptr<Scope> currentScope;
-
-  void checkEntity(const std::shared_ptr<Entity> &entity);
-  void checkBlock(const std::shared_ptr<Block> &block);
-  void checkMethodCall(const std::shared_ptr<MethodCallEXP> &methodCall);
-  // void checkAssignment(const std::shared_ptr<AssignmentSTMT>& assignment);
-  // void checkVariableDecl(const std::shared_ptr<VarDecl>& varDecl);
-  void checkFunctionDecl(const std::shared_ptr<FuncDecl> &funcDecl);
-  void resolveType(const std::shared_ptr<Expression> &expr);
-  void reportError(const std::string &message, const Loc &loc);
-}; */
-
-#endif
\ No newline at end of file
+  // `arr` of arr[i], see visit(VarRefEXP)
+  const Expression *indexedArray = nullptr;
+
+  void annotate(Expression &expr);
+  // sets VarDecl::isModified of a local
+  void markModified(const std::string &name);
+
+  // phase 1
+  void checkSignatures(ModuleDecl &module);
+  void checkSignature(const std::string &name,
+                      const std::vector<std::shared_ptr<ParameterDecl>> &args,
+                      const std::shared_ptr<TypeFunc> &signature);
+  void checkAttributes(const Decl &decl);
+  // unroll, vectorize and interleave hints of a loop
+  void checkLoopHints(const Attributes &hints);
+  // phase 2
+  void analyzeInitializers(ModuleDecl &module);
+  // phase 3
+  void analyzeBodies(ModuleDecl &module);
+  // phase 4
+  void evaluateCalls(ModuleDecl &module);
+  // phase 5
+  void findEscapes(ModuleDecl &module);
+
+  void reportError(const std::string &message);
+
+  // value of a case label, an integer literal
+  // or an enum item, nullopt for anything else
+  std::optional<int64_t> labelOf(const Expression &label);
+
+  // visits a node in a scope of its own (set by parser)
+  template <typename F>
+  void inScope(const std::shared_ptr<Scope<Entity>> &scope, F &&body) {
+    auto enclosingScope = currentScope;
+    if (scope) currentScope = scope;
+    body();
+    currentScope = enclosingScope;
+  }
+};
+
+#endif
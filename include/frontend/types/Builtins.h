@@ -0,0 +1,206 @@
+#ifndef OBW_BUILTINS_H
+#define OBW_BUILTINS_H
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+#include "Types.h"
+#include "frontend/parser/Expression.h"
+
+/**
+ * Methods of builtin classes (Integer, i64, Real, Boolean)
+ * that codegen lowers directly into instructions, and of
+ * String, calls of its runtime (see runtime/String.h)
+ */
+enum BuiltinMethod {
+  BM_NONE = -1,
+  BM_PLUS,
+  BM_MINUS,
+  BM_MULT,
+  BM_DIV,
+  BM_REM,
+  BM_LESS,
+  BM_GREATER,
+  BM_EQUAL,
+  BM_UNARY_MINUS,
+  BM_SIZE,
+  BM_AND,
+  BM_OR,
+  BM_NOT,
+  BM_APPEND,
+  BM_PUSH,
+  BM_CONCAT,
+  BM_COUNT
+};
+
+inline constexpr std::array<std::string_view, BM_COUNT> BUILTIN_METHOD_NAMES = {
+    "Plus", "Minus",      "Mult", "Div", "Rem", "Less", "Greater",
+    "Equal", "UnaryMinus", "Size", "And", "Or",  "Not",
+    "Append", "Push", "Concat"};
+
+/**
+ * Signature of a builtin method
+ * param is TYPE_UNKNOWN for methods without arguments
+ */
+struct BuiltinSignature {
+  TypeKind self;
+  BuiltinMethod method;
+  TypeKind param;
+  TypeKind ret;
+};
+
+namespace builtins {
+
+constexpr BuiltinSignature binary(TypeKind self, BuiltinMethod method,
+                                  TypeKind ret) {
+  return {self, method, self, ret};
+}
+
+constexpr BuiltinSignature unary(TypeKind self, BuiltinMethod method,
+                                 TypeKind ret) {
+  return {self, method, TYPE_UNKNOWN, ret};
+}
+
+// Integer, i64 and Real share the arithmetic set
+#define OBW_ARITHMETIC_BUILTINS(KIND, SIZE_KIND)                               \
+  binary(KIND, BM_PLUS, KIND), binary(KIND, BM_MINUS, KIND),                   \
+      binary(KIND, BM_MULT, KIND), binary(KIND, BM_DIV, KIND),                 \
+      binary(KIND, BM_REM, KIND), binary(KIND, BM_LESS, TYPE_BOOL),            \
+      binary(KIND, BM_GREATER, TYPE_BOOL), binary(KIND, BM_EQUAL, TYPE_BOOL),  \
+      unary(KIND, BM_UNARY_MINUS, KIND), unary(KIND, BM_SIZE, SIZE_KIND)
+
+inline constexpr BuiltinSignature SIGNATURES[] = {
+    OBW_ARITHMETIC_BUILTINS(TYPE_INT, TYPE_INT),
+    OBW_ARITHMETIC_BUILTINS(TYPE_I64, TYPE_I64),
+    OBW_ARITHMETIC_BUILTINS(TYPE_REAL, TYPE_INT),
+    binary(TYPE_BOOL, BM_AND, TYPE_BOOL),
+    binary(TYPE_BOOL, BM_OR, TYPE_BOOL),
+    unary(TYPE_BOOL, BM_NOT, TYPE_BOOL),
+    binary(TYPE_BOOL, BM_EQUAL, TYPE_BOOL),
+    unary(TYPE_BOOL, BM_SIZE, TYPE_INT),
+    // Append and Push change a string in place and return
+    // it, Concat makes a new one, Size is a length in bytes
+    binary(TYPE_STRING, BM_APPEND, TYPE_STRING),
+    {TYPE_STRING, BM_PUSH, TYPE_BYTE, TYPE_STRING},
+    binary(TYPE_STRING, BM_CONCAT, TYPE_STRING),
+    binary(TYPE_STRING, BM_EQUAL, TYPE_BOOL),
+    unary(TYPE_STRING, BM_SIZE, TYPE_I64),
+};
+
+#undef OBW_ARITHMETIC_BUILTINS
+
+// builtin receiver kinds, index of a row in the dispatch table
+inline constexpr std::array<TypeKind, 5> RECEIVERS = {
+    TYPE_INT, TYPE_I64, TYPE_REAL, TYPE_BOOL, TYPE_STRING};
+
+constexpr int receiverIndex(TypeKind kind) {
+  for (size_t i = 0; i < RECEIVERS.size(); i++)
+    if (RECEIVERS[i] == kind)
+      return static_cast<int>(i);
+  return -1;
+}
+
+//========== PERFECT HASH OF METHOD NAMES ==========
+// seeded FNV-1a (top bits), seed is searched at compile time
+// so that every builtin name lands in its own slot
+
+inline constexpr uint32_t HASH_SLOTS = 32;
+
+constexpr uint32_t hash(std::string_view name, uint32_t seed) {
+  uint32_t h = 2166136261u ^ seed;
+  for (char c : name) {
+    h ^= static_cast<unsigned char>(c);
+    h *= 16777619u;
+  }
+  return h >> 27; // 32 slots
+}
+
+constexpr bool isPerfect(uint32_t seed) {
+  std::array<bool, HASH_SLOTS> used{};
+  for (auto name : BUILTIN_METHOD_NAMES) {
+    auto slot = hash(name, seed);
+    if (used[slot])
+      return false;
+    used[slot] = true;
+  }
+  return true;
+}
+
+constexpr uint32_t findSeed() {
+  uint32_t seed = 0;
+  while (!isPerfect(seed))
+    seed++;
+  return seed;
+}
+
+inline constexpr uint32_t SEED = findSeed();
+
+constexpr std::array<BuiltinMethod, HASH_SLOTS> buildSlots() {
+  std::array<BuiltinMethod, HASH_SLOTS> slots{};
+  for (auto &slot : slots)
+    slot = BM_NONE;
+  for (int i = 0; i < BM_COUNT; i++)
+    slots[hash(BUILTIN_METHOD_NAMES[i], SEED)] = static_cast<BuiltinMethod>(i);
+  return slots;
+}
+
+inline constexpr auto SLOTS = buildSlots();
+
+//========== (RECEIVER, METHOD) -> SIGNATURE ==========
+
+using DispatchTable =
+    std::array<std::array<const BuiltinSignature *, BM_COUNT>,
+               RECEIVERS.size()>;
+
+constexpr DispatchTable buildDispatch() {
+  DispatchTable table{};
+  for (const auto &sig : SIGNATURES)
+    table[receiverIndex(sig.self)][sig.method] = &sig;
+  return table;
+}
+
+inline constexpr DispatchTable DISPATCH = buildDispatch();
+
+} // namespace builtins
+
+/**
+ * @brief Maps a method name onto builtin method id
+ * @return BM_NONE if name is not a builtin method
+ */
+constexpr BuiltinMethod lookupBuiltinMethod(std::string_view name) {
+  auto method = builtins::SLOTS[builtins::hash(name, builtins::SEED)];
+  if (method == BM_NONE || BUILTIN_METHOD_NAMES[method] != name)
+    return BM_NONE;
+  return method;
+}
+
+/**
+ * @brief Finds builtin method of a builtin class
+ * @return nullptr if `self` does not have such builtin method
+ */
+constexpr const BuiltinSignature *findBuiltin(TypeKind self,
+                                              BuiltinMethod method) {
+  auto row = builtins::receiverIndex(self);
+  if (row < 0 || method == BM_NONE)
+    return nullptr;
+  return builtins::DISPATCH[row][method];
+}
+
+/**
+ * @brief x.Plus(y) of a typed receiver with such a builtin
+ * method, String ones too, shared by passes over bodies
+ */
+inline bool isBuiltinCall(const MethodCallEXP &node) {
+  if (!node.left || !node.left->type)
+    return false;
+  return findBuiltin(node.left->type->kind,
+                     lookupBuiltinMethod(node.getName())) != nullptr;
+}
+
+static_assert(lookupBuiltinMethod("UnaryMinus") == BM_UNARY_MINUS);
+static_assert(lookupBuiltinMethod("Length") == BM_NONE);
+static_assert(findBuiltin(TYPE_BOOL, BM_NOT)->ret == TYPE_BOOL);
+static_assert(findBuiltin(TYPE_BOOL, BM_PLUS) == nullptr);
+
+#endif
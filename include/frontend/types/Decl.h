@@ -17,6 +17,7 @@
 
 #include <filesystem>
 #include <map>
+#include <unordered_map>
 
 class Decl : public Entity {
 public:
@@ -27,6 +28,17 @@ public:
 
   bool validate() override;
 
+  // as written, checked by SemanticAnalyzer
+  Attributes attributes;
+
+  const Attribute *attribute(const std::string &name) const {
+    for (const auto &attr : attributes) {
+      if (attr.name == name)
+        return &attr;
+    }
+    return nullptr;
+  }
+
   ~Decl() override;
 
   DEFINE_VISITABLE()
@@ -85,6 +97,11 @@ public:
   //                 ^^^^
   std::shared_ptr<Expression> initializer;
 
+  // assigned, an element or a field of an element assigned,
+  // or used other than arr[i], set for locals by SemanticAnalyzer.
+  // An array literal of a local never modified is not copied
+  bool isModified = false;
+
   std::shared_ptr<Type> resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) override;
 
   bool validate() override;
@@ -130,7 +147,7 @@ public:
   MethodDecl(const std::string &name)
       : Decl(E_Method_Decl, name), isForward(false), isShort(false),
         isVoided(false), isVoid(false), isBuiltin(false), isStatic(false),
-        isPrivate(false) {}
+        isPrivate(false), isInherited(false), isVirtual(false), isOverride(false) {}
   explicit MethodDecl(const std::string &name,
                       std::shared_ptr<TypeFunc> signature,
                       std::vector<std::shared_ptr<ParameterDecl>> args,
@@ -138,7 +155,8 @@ public:
       : Decl(E_Method_Decl, name), signature(std::move(signature)),
         args(std::move(args)), isForward(false), isShort(false),
         isVoided(false), isVoid(signature->isVoid), isBuiltin(false),
-        isStatic(false), isPrivate(false), isInherited(false), body(std::move(body)) {}
+        isStatic(false), isPrivate(false), isInherited(false), isVirtual(false),
+        isOverride(false), body(std::move(body)) {}
 
   explicit MethodDecl(const std::string &name,
                       std::shared_ptr<TypeFunc> signature,
@@ -146,7 +164,8 @@ public:
       : Decl(E_Method_Decl, name), signature(std::move(signature)), args(),
         isForward(false), isShort(false), isVoided(true),
         isVoid(signature->isVoid), isBuiltin(false), isStatic(false),
-        isPrivate(false),isInherited(false), body(std::move(body)) {}
+        isPrivate(false),isInherited(false), isVirtual(false), isOverride(false),
+        body(std::move(body)) {}
 
   explicit MethodDecl(const std::string &name,
                       const std::shared_ptr<TypeFunc> &signature,
@@ -155,7 +174,8 @@ public:
       : Decl(E_Method_Decl, name), signature(signature), args(args),
         isForward(false), isShort(false), isVoided(false),
         isVoid(signature->isVoid), isBuiltin(isBuiltin), isStatic(false),
-        isPrivate(false),isInherited(false), body() {}
+        isPrivate(false),isInherited(false), isVirtual(false), isOverride(false),
+        body() {}
 
   std::shared_ptr<TypeFunc> signature;
   std::vector<std::shared_ptr<ParameterDecl>> args;
@@ -168,7 +188,19 @@ public:
   bool isStatic;
   bool isPrivate;
   bool isInherited;
+  bool isVirtual;  // `virtual`, or overrides a virtual method
+  bool isOverride; // `override`, checked by SemanticAnalyzer
   std::shared_ptr<Block> body;
+  std::shared_ptr<Scope<Entity>> scope; // set by parser
+
+  // inherited copy -> method of a base class it names,
+  // the only one compiled (set by parser)
+  std::shared_ptr<MethodDecl> original;
+
+  // method compiled for this one
+  const MethodDecl &implementation() const {
+    return isInherited && original ? *original : *this;
+  }
 
   std::shared_ptr<Type> resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) override;
 
@@ -193,6 +225,7 @@ public:
   std::vector<std::shared_ptr<ParameterDecl>> args;
 
   std::shared_ptr<Block> body;
+  std::shared_ptr<Scope<Entity>> scope; // set by parser
 
   std::shared_ptr<Type> resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) override;
 
@@ -230,6 +263,7 @@ public:
   bool isVoided; // no parameters
   bool isVoid;
   std::shared_ptr<Block> body;
+  std::shared_ptr<Scope<Entity>> scope; // set by parser
 
   std::shared_ptr<Type> resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) override;
 
@@ -240,6 +274,16 @@ public:
   DEFINE_VISITABLE()
 };
 
+/**
+ * Place of a field in an object of a class,
+ * set by ClassLayout (see backend)
+ */
+struct FieldLayout {
+  unsigned index;   // in a struct of a class
+  uint64_t offset;  // in bytes, by a DataLayout of a target
+  llvm::Type *type;
+};
+
 /**
  * Basic "block" of every OBW programm
  * constuct a new type of <ClassName>
@@ -279,6 +323,26 @@ public:
   // std::vector<std::shared_ptr<MethodDecl>> methods;
   // std::vector<std::shared_ptr<ConstrDecl>> constructors;
   std::vector<std::shared_ptr<Decl>> methods; // btoh methods and constrs
+  std::shared_ptr<Scope<Entity>> scope; // set by parser
+
+  // slot -> implementation in this class, starts
+  // with a vtable of a base class (set by ClassHierarchy)
+  std::vector<std::shared_ptr<MethodDecl>> vtable;
+
+  // base fields first, then own ones (set by ClassLayout)
+  llvm::StructType *structType = nullptr;
+  std::unordered_map<std::string, FieldLayout> layout;
+  int vptrIndex = -1; // -1 if a hierarchy has no vtable
+  uint64_t align = 0;  // over an ABI one, by align(N) of it or a field
+
+  // made of a template, every module that uses it has
+  // a copy, methods are linkonce_odr (see Parser::instantiate)
+  bool isInstance = false;
+
+  const FieldLayout *fieldLayout(const std::string &name) const {
+    auto it = layout.find(name);
+    return it != layout.end() ? &it->second : nullptr;
+  }
 
   std::shared_ptr<Type> resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) override;
 
@@ -299,6 +363,7 @@ public:
 
   std::vector<std::string> importedModules;
   std::vector<std::shared_ptr<Entity>> children;
+  std::shared_ptr<Scope<Entity>> scope; // set by parser
 
   DEFINE_VISITABLE()
 };
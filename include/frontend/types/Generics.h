@@ -5,6 +5,7 @@
 // but obviously without constraints
 
 #include "Types.h"
+#include "frontend/lexer/Lexer.h"
 
 class TypeOpaque : public Type {
 public:
@@ -16,6 +17,42 @@ public:
   };
 };
 
+/**
+ * @phase Parsing
+ *
+ * A generic class, its tokens are kept as they were
+ * read and parsed again per distinct arguments:
+ *
+ *   class List[T] is              List[Integer]  ->  class List[Integer]
+ *     var items : Array[T, 16]                        var items : Array[Integer, 16]
+ *     ...                         List[Point]    ->  class List[Point]
+ *   end                                               ...
+ *
+ * so an instance is a class as any other, with its own
+ * struct and methods, an element is stored in place and
+ * T.Size() is a constant (see Parser::instantiate)
+ *
+ * @note only classes are generic, a method or a function
+ * with type parameters of its own is not supported
+ *
+ * @note never lowered, only instances get to codegen
+ */
+class TypeGenericClass : public Type {
+public:
+  TypeGenericClass(std::string name, std::vector<std::string> params,
+                   std::vector<Token> body)
+    : Type(TYPE_GENERIC, std::move(name)), params(std::move(params)),
+      body(std::move(body)) {}
+
+  std::vector<std::string> params;
+  std::vector<Token> body; // `class` ... `end`
+
+  llvm::Type *toLLVMType(llvm::LLVMContext &lc) override {
+    (void)lc;
+    return nullptr;
+  };
+};
+
 class ValueWitnessTable {
 public:
   size_t size;
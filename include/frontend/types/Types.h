@@ -50,7 +50,8 @@ enum TypeKind {
   TYPE_GENERIC,
   TYPE_POINTER,
   TYPE_ACCESS,
-  TYPE_OPAQUE
+  TYPE_OPAQUE,
+  TYPE_KIND_COUNT
 };
 
 class Type {
@@ -234,16 +235,15 @@ public:
   }
 };
 
+// a pointer to an ObwString of the runtime, see runtime/String.h
 class TypeString : public TypeBuiltin {
 public:
-  // 8 bits -> 1 byte for '\0'
-  TypeString() : TypeBuiltin(TYPE_STRING, "String", 8) {}
+  TypeString() : TypeBuiltin(TYPE_STRING, "String", 64) {}
 
   TypeString(size_t size) : TypeBuiltin(TYPE_STRING, "String", size) {}
 
   llvm::Type *toLLVMType(llvm::LLVMContext &lc) override {
-    (void)lc;
-    return nullptr;
+    return llvm::PointerType::get(lc, 0);
   }
 };
 
@@ -0,0 +1,70 @@
+#ifndef OBW_RUNTIME_STRING_H
+#define OBW_RUNTIME_STRING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// bytes kept inside a string itself, a NUL included
+#define OBW_STRING_SMALL 16
+
+/**
+ * @phase Runtime
+ *
+ * A builtin String, programs hold a pointer to it:
+ *
+ *   var s : String := String("id")    ->  obw_string_new("id", 2)
+ *   s.Append(name).Push(59)           ->  obw_string_append(s, ...)
+ *                                         obw_string_push(s, ';')
+ *   s.Size()                          ->  s->length, read in place
+ *
+ * Bytes are NUL terminated, so data is a C string.
+ * Up to OBW_STRING_SMALL - 1 of them live in small,
+ * a short string is one allocation. A longer one gets
+ * a buffer that grows twice at a time, so an append
+ * is amortized O(1)
+ *
+ * @note a String that does not escape a function is
+ * freed by obw_string_free when it returns, any other
+ * lives until exit (see EscapeAnalysis)
+ *
+ * @note codegen reads length at offset 0 and passes
+ * data to a variadic C function (printf), keep both
+ */
+typedef struct ObwString {
+  int64_t length;
+  int64_t capacity; // bytes data may hold, a NUL excluded
+  char *data;       // small or a heap buffer
+  char small[OBW_STRING_SMALL];
+} ObwString;
+
+ObwString *obw_string_new(const char *bytes, int64_t length);
+
+// makes room for capacity bytes, a builder reserves once
+void obw_string_reserve(ObwString *string, int64_t capacity);
+
+// append and push return string, so calls chain
+ObwString *obw_string_append(ObwString *string, const char *bytes,
+                             int64_t length);
+ObwString *obw_string_push(ObwString *string, char byte);
+
+// a new string, room for both is made once
+ObwString *obw_string_concat(const ObwString *left, const ObwString *right);
+// the same of bytes, s.Concat("lit") makes no String of a literal
+ObwString *obw_string_concat_bytes(const ObwString *left, const char *bytes,
+                                   int64_t length);
+
+bool obw_string_equal(const ObwString *left, const ObwString *right);
+bool obw_string_equal_bytes(const ObwString *left, const char *bytes,
+                            int64_t length);
+
+void obw_string_free(ObwString *string);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,158 @@
+#ifndef OBW_THREAD_POOL_H
+#define OBW_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Fixed set of workers with a task deque per worker
+ *
+ * A worker takes tasks from the back of its own deque
+ * and when it runs dry steals from the front of the others,
+ * so uneven tasks (small vs huge method bodies) still
+ * keep every core busy
+ *
+ * @note tasks must not submit new tasks
+ */
+class ThreadPool {
+public:
+  using Task = std::function<void()>;
+
+  static size_t defaultWorkers() {
+    return std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  explicit ThreadPool(size_t workers = defaultWorkers()) {
+    workers = std::max<size_t>(1, workers);
+    for (size_t i = 0; i < workers; i++)
+      queues.push_back(std::make_unique<Queue>());
+    for (size_t i = 0; i < workers; i++)
+      threads.emplace_back([this, i] { run(i); });
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard lock(mutex);
+      stopping = true;
+    }
+    hasWork.notify_all();
+    for (auto &thread : threads)
+      thread.join();
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  // tasks are dealt round-robin, stealing evens them out
+  void submit(Task task) {
+    // counted first, a worker may take a task as soon
+    // as it is pushed and must not count below zero
+    {
+      std::lock_guard lock(mutex);
+      queued++;
+      pending++;
+    }
+    auto &queue = *queues[nextQueue++ % queues.size()];
+    {
+      std::lock_guard lock(queue.mutex);
+      queue.tasks.push_back(std::move(task));
+    }
+    hasWork.notify_one();
+  }
+
+  /**
+   * @brief Blocks until every submitted task is done
+   * @note rethrows first exception thrown by a task
+   */
+  void wait() {
+    std::unique_lock lock(mutex);
+    allDone.wait(lock, [this] { return pending == 0; });
+    if (failure)
+      std::rethrow_exception(std::exchange(failure, nullptr));
+  }
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  std::vector<std::unique_ptr<Queue>> queues;
+  std::vector<std::thread> threads;
+
+  std::mutex mutex;
+  std::condition_variable hasWork;
+  std::condition_variable allDone;
+  size_t queued = 0;  // sitting in deques
+  size_t pending = 0; // submitted and not finished yet
+  bool stopping = false;
+  std::exception_ptr failure;
+
+  std::atomic<size_t> nextQueue = 0;
+
+  bool take(size_t self, Task &task) {
+    // own deque from the back
+    {
+      auto &own = *queues[self];
+      std::lock_guard lock(own.mutex);
+      if (!own.tasks.empty()) {
+        task = std::move(own.tasks.back());
+        own.tasks.pop_back();
+        return true;
+      }
+    }
+    // steal from the front of the others
+    for (size_t i = 1; i < queues.size(); i++) {
+      auto &victim = *queues[(self + i) % queues.size()];
+      std::lock_guard lock(victim.mutex);
+      if (!victim.tasks.empty()) {
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void run(size_t self) {
+    for (;;) {
+      Task task;
+      if (take(self, task)) {
+        {
+          std::lock_guard lock(mutex);
+          queued--;
+        }
+
+        std::exception_ptr error;
+        try {
+          task();
+        } catch (...) {
+          error = std::current_exception();
+        }
+
+        std::lock_guard lock(mutex);
+        if (error && !failure)
+          failure = error;
+        if (--pending == 0)
+          allDone.notify_all();
+        continue;
+      }
+
+      std::unique_lock lock(mutex);
+      hasWork.wait(lock, [this] { return stopping || queued > 0; });
+      if (stopping && queued == 0)
+        return;
+    }
+  }
+};
+
+#endif
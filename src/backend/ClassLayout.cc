@@ -0,0 +1,239 @@
+#include "backend/ClassLayout.h"
+
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MathExtras.h"
+
+#include <algorithm>
+
+ClassLayout::ClassLayout(llvm::LLVMContext &context,
+                         const llvm::DataLayout &dataLayout,
+                         const std::shared_ptr<Scope<Entity>> &globalScope)
+    : context(context), dataLayout(dataLayout) {
+  for (const auto &module : globalScope->getChildren()) {
+    if (module->getKind() != SCOPE_MODULE)
+      continue;
+    for (auto &[name, symbol] : module->getSymbols()) {
+      if (symbol.decl && symbol.decl->getKind() == E_Class_Decl)
+        classes[name] = std::static_pointer_cast<ClassDecl>(symbol.decl).get();
+    }
+  }
+}
+
+ClassDecl *ClassLayout::classOf(const std::string &name) {
+  auto it = classes.find(name);
+  if (it == classes.end())
+    return nullptr;
+  layoutOf(*it->second);
+  return it->second;
+}
+
+llvm::Type *ClassLayout::lower(const std::shared_ptr<Type> &type) {
+  switch (type->kind) {
+  case TYPE_CLASS:
+    if (auto classDecl = classOf(type->name))
+      return classDecl->structType;
+    break;
+  case TYPE_ACCESS:
+    // pointee is not needed, so a class may point to itself
+    return llvm::PointerType::get(context, 0);
+  case TYPE_ARRAY: {
+    auto array = std::static_pointer_cast<TypeArray>(type);
+    return llvm::ArrayType::get(lower(array->el_type), array->size);
+  }
+  case TYPE_LIST:
+    return llvm::ArrayType::get(
+        lower(std::static_pointer_cast<TypeList>(type)->el_type), 0);
+  default:
+    break;
+  }
+  return type->toLLVMType(context);
+}
+
+uint64_t ClassLayout::alignOf(const std::shared_ptr<Type> &type) {
+  switch (type->kind) {
+  case TYPE_CLASS:
+    if (auto classDecl = classOf(type->name))
+      return classDecl->align;
+    break;
+  case TYPE_ARRAY:
+    return alignOf(std::static_pointer_cast<TypeArray>(type)->el_type);
+  case TYPE_LIST:
+    return alignOf(std::static_pointer_cast<TypeList>(type)->el_type);
+  default:
+    break;
+  }
+  return 0;
+}
+
+llvm::StructType *ClassLayout::layoutOf(ClassDecl &classDecl) {
+  // also breaks a cycle of by value fields
+  if (classDecl.structType)
+    return classDecl.structType;
+  classDecl.structType =
+      llvm::StructType::create(context, llvm::StringRef(classDecl.getName()));
+
+  auto base = classDecl.base_class.get();
+  if (base)
+    layoutOf(*base);
+
+  // wrong ones are reported by SemanticAnalyzer
+  bool packed = base ? base->structType->isPacked()
+                     : classDecl.attribute("packed") != nullptr;
+  uint64_t align = 0;
+  if (auto attr = classDecl.attribute("align");
+      attr && attr->value && *attr->value > 0 &&
+      llvm::isPowerOf2_64(*attr->value))
+    align = *attr->value;
+
+  // empty name is a vptr or a padding
+  struct Slot {
+    std::string name;
+    llvm::Type *type;
+    uint64_t align;
+  };
+  std::vector<llvm::Type *> elements;
+  std::vector<std::string> names;
+  uint64_t size = 0;
+  if (base) {
+    auto baseElements = base->structType->elements();
+    elements.assign(baseElements.begin(), baseElements.end());
+    names.resize(elements.size());
+    for (const auto &[name, field] : base->layout)
+      names[field.index] = name;
+    classDecl.vptrIndex = base->vptrIndex;
+    align = std::max(align, base->align);
+    // own fields may go to a tail padding of a base
+    if (!elements.empty()) {
+      auto baseLayout = dataLayout.getStructLayout(base->structType);
+      size = baseLayout->getElementOffset(elements.size() - 1) +
+             dataLayout.getTypeAllocSize(elements.back());
+    }
+  }
+
+  // parser puts a base as field 0 and appends
+  // fields of a base, both are laid out above
+  std::vector<Slot> slots;
+  for (size_t i = 0; i < classDecl.fields.size(); i++) {
+    const auto &field = classDecl.fields[i];
+    if (!field->type ||
+        (base && (i == 0 || std::ranges::find(base->fields, field) !=
+                                base->fields.end())))
+      continue;
+    slots.push_back({field->getName(), lower(field->type), alignOf(field->type)});
+  }
+  bool ownsVptr = !classDecl.vtable.empty() && classDecl.vptrIndex < 0;
+  if (ownsVptr)
+    slots.push_back({"", llvm::PointerType::get(context, 0), 0});
+
+  auto natural = [&](llvm::Type *type) -> uint64_t {
+    return packed ? 1 : dataLayout.getABITypeAlign(type).value();
+  };
+  if (classDecl.attribute("reorder")) {
+    std::ranges::stable_sort(slots, std::greater<>(), [&](const Slot &slot) {
+      return std::max(natural(slot.type), slot.align);
+    });
+  }
+
+  // padding is explicit only where align(N) asks for more
+  // than a type has, otherwise LLVM puts it the same way
+  auto i8 = llvm::Type::getInt8Ty(context);
+  auto pad = [&](uint64_t to) {
+    if (to > size) {
+      elements.push_back(llvm::ArrayType::get(i8, to - size));
+      names.emplace_back();
+      size = to;
+    }
+  };
+  for (const auto &slot : slots) {
+    auto required = std::max(natural(slot.type), slot.align);
+    if (required > natural(slot.type))
+      pad(llvm::alignTo(size, required));
+    size = llvm::alignTo(size, natural(slot.type));
+
+    if (slot.name.empty() && ownsVptr)
+      classDecl.vptrIndex = static_cast<int>(elements.size());
+    elements.push_back(slot.type);
+    names.push_back(slot.name);
+    size += dataLayout.getTypeAllocSize(slot.type);
+    align = std::max(align, slot.align);
+  }
+
+  // one object per N bytes, arrays of them too
+  if (align)
+    pad(llvm::alignTo(size, align));
+  classDecl.align = align;
+  classDecl.structType->setBody(elements, packed);
+
+  auto structLayout = classDecl.structType->isSized()
+                          ? dataLayout.getStructLayout(classDecl.structType)
+                          : nullptr;
+  for (unsigned index = 0; index < elements.size(); index++) {
+    if (names[index].empty())
+      continue;
+    uint64_t offset = 0;
+    if (structLayout)
+      offset = structLayout->getElementOffset(index);
+    // own field of the same name hides an inherited one
+    classDecl.layout[names[index]] = {index, offset, elements[index]};
+  }
+  return classDecl.structType;
+}
+
+bool ClassLayout::isPadding(const ClassDecl &classDecl, unsigned index) {
+  if (static_cast<int>(index) == classDecl.vptrIndex)
+    return false;
+  return std::ranges::none_of(classDecl.layout, [&](const auto &field) {
+    return field.second.index == index;
+  });
+}
+
+llvm::StructType *ClassLayout::soaOf(ClassDecl &classDecl, uint64_t count) {
+  auto structType = layoutOf(classDecl);
+  std::vector<llvm::Type *> arrays;
+  for (unsigned index = 0; index < structType->getNumElements(); index++) {
+    arrays.push_back(llvm::ArrayType::get(
+        structType->getElementType(index),
+        isPadding(classDecl, index) ? 0 : count));
+  }
+  return llvm::StructType::get(context, arrays);
+}
+
+void ClassLayout::report(const ClassDecl &classDecl,
+                         llvm::raw_ostream &out) const {
+  auto structType = classDecl.structType;
+  if (!structType || !structType->isSized())
+    return;
+  auto structLayout = dataLayout.getStructLayout(structType);
+  uint64_t size = structLayout->getSizeInBytes();
+  uint64_t align = std::max<uint64_t>(classDecl.align,
+                                      structLayout->getAlignment().value());
+
+  std::vector<std::string> names(structType->getNumElements());
+  for (const auto &[name, field] : classDecl.layout)
+    names[field.index] = name;
+  if (classDecl.vptrIndex >= 0)
+    names[classDecl.vptrIndex] = "<vptr>";
+
+  std::string lines;
+  llvm::raw_string_ostream fields(lines);
+  uint64_t used = 0;
+  for (unsigned index = 0; index < names.size(); index++) {
+    // explicit padding is counted as a gap
+    if (names[index].empty())
+      continue;
+    auto type = structType->getElementType(index);
+    uint64_t offset = structLayout->getElementOffset(index);
+    uint64_t fieldSize = dataLayout.getTypeAllocSize(type);
+    used += fieldSize;
+    fields << llvm::format("  %6llu  %-16s %4llu  ",
+                           static_cast<unsigned long long>(offset),
+                           names[index].c_str(),
+                           static_cast<unsigned long long>(fieldSize));
+    type->print(fields, false, true);
+    fields << "\n";
+  }
+
+  out << "class " << classDecl.getName() << ": size " << size << ", align "
+      << align << ", padding " << size - used << "\n"
+      << lines;
+}
@@ -6,6 +6,8 @@
 #include "backend/CodegenVisitor.h"
 #include "lld/Common/Driver.h"
 #include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/DiagnosticHandler.h"
+#include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/IntrinsicInst.h"
 
 // #include "lld/Common/"
@@ -13,11 +15,36 @@
 #include "util/Logger.h"
 
 #include <complex>
+#include <set>
 #include <llvm/Support/Chrono.h>
 
 #define CG_ERR(path, msg)                                                   \
 ERR("%s: %s\n", path, msg)
 
+namespace {
+
+// loop hints a pipeline could not honor, reported by
+// WarnMissedTransformations, as warnings of a compiler
+struct LoopHintHandler : llvm::DiagnosticHandler {
+  std::string moduleName;
+
+  explicit LoopHintHandler(std::string moduleName)
+      : moduleName(std::move(moduleName)) {}
+
+  bool handleDiagnostics(const llvm::DiagnosticInfo &info) override {
+    if (info.getKind() != llvm::DK_OptimizationFailure)
+      return false;
+    auto &failure =
+        static_cast<const llvm::DiagnosticInfoOptimizationFailure &>(info);
+    llvm::errs() << "warning: " << moduleName << ": "
+                 << failure.getFunction().getName() << ": "
+                 << failure.getMsg() << "\n";
+    return true;
+  }
+};
+
+} // namespace
+
 
 void CodeGenVisitor::visit(Entity &node) {
   // // Because E_Kind enum values
@@ -59,7 +86,7 @@ void CodeGenVisitor::visit(ConversionEXP &node) {
   auto fromVal = lastValue;
   // if (!fromVal) return nul/lptr;
 
-  auto fromType = fromExpr->resolveType(typeTable->types[moduleName], currentScope);
+  auto fromType = typeOf(*fromExpr);
   auto toType = node.to;
 
   auto itof = fromType->kind == TYPE_INT;
@@ -94,24 +121,24 @@ void CodeGenVisitor::visit(ConversionEXP &node) {
 }
 
 void CodeGenVisitor::visit(ElementRefEXP &node) {
-  node.index->accept(*this);
-  // load index value -> index is an Expresssion
-  auto indexVal = unwrapPointerReference(node.index.get(), lastValue);
-
-  // convert index to i64 if it's not already
-  if (indexVal->getType() != llvm::Type::getInt64Ty(*context)) {
-    indexVal = builder->CreateSExt(indexVal, llvm::Type::getInt64Ty(*context));
-  }
+  auto indexVal = indexOf(node);
 
   // array type
   // @TODO: field as `arr`
   auto [arrDecl , arrAlloca, arrInited ] = *currentScope->getSymbol(node.arr->getName());
-  auto arrType = arrDecl->resolveType(typeTable->types[moduleName], currentScope);
+  auto arrType = typeOf(*node.arr);
+
+  // an element of a soa array is put together in a copy
+  if (auto classDecl = soaClassOf(arrDecl.get())) {
+    lastValue = gatherElement(*classDecl, arrAlloca,
+                              storedType(arrAlloca, arrDecl.get()), indexVal);
+    return;
+  }
 
   if (arrType->kind == TYPE_ACCESS) {
     auto ptrType = std::static_pointer_cast<TypeAccess>(arrType);
     auto load = builder->CreateLoad(
-      arrAlloca->getAllocatedType(),
+      storedType(arrAlloca, arrDecl.get()),
       arrAlloca
     );
 
@@ -126,7 +153,7 @@ void CodeGenVisitor::visit(ElementRefEXP &node) {
     // GEP with two indices: [0, index]
     auto zero = llvm::ConstantInt::get(llvm::Type::getInt64Ty(*context), 0);
     lastValue = builder->CreateGEP(
-      arrAlloca->getAllocatedType(),
+      storedType(arrAlloca, arrDecl.get()),
       arrAlloca,
       {zero, indexVal}
     );
@@ -148,97 +175,49 @@ void CodeGenVisitor::visit(AssignmentWrapperEXP &node) {
 
 // a.x
 void CodeGenVisitor::visit(FieldRefEXP &node) {
+  llvm::Value* object = nullptr;
   std::shared_ptr<Type> varType = nullptr;
-  llvm::AllocaInst* alloca = nullptr;
-  bool isInherited = false;
 
   if (node.obj) {
-    auto [decl, temp_alloca, isInited] = *currentScope->getSymbol(node.obj->getName());
-
-    alloca = temp_alloca;
-    varType = decl->resolveType(typeTable->types[moduleName], currentScope);
-
-    // check if inherited
-    if (varType->kind == TYPE_ACCESS) {
-      auto className = currentScope->prevScope()->getName();
-      auto fieldName = node.getName(); // get field name
-      auto [classDecl, _, __] = *currentScope->getSymbol<ClassDecl>(className);
-      if (!std::any_of(classDecl->fields.begin(), classDecl->fields.end(),
-        [&](auto &f) { return f->getName() == fieldName; }))
-      {
-        // first load a copy
-        isInherited = true;
-      }
-    }
-    else {
-      auto fieldName = node.getName(); // get field name
-      auto [classDecl, _, __] = *currentScope->getSymbol<ClassDecl>(varType->name);
-      if (!std::any_of(classDecl->fields.begin(), classDecl->fields.end(),
-        [&](auto &f) { return f->getName() == fieldName; }))
-      {
-        // first load a copy
-        isInherited = true;
-      }
-    }
-
+    auto [decl, alloca, isInited] = *currentScope->getSymbol(node.obj->getName());
+    object = alloca;
+    varType = typeOf(*node.obj);
   }
   else if (node.el) {
-    auto var_ref = node.el->arr;
-    auto obj_decl = std::static_pointer_cast<VarDecl>(
-      currentScope->lookup(var_ref->getName()));
+    // one array per field, so a loop over elements is unit stride
+    auto [arrDecl, arrAlloca, arrInited] = *currentScope->getSymbol(node.el->arr->getName());
+    if (auto classDecl = soaClassOf(arrDecl.get())) {
+      if (auto field = classDecl->fieldLayout(node.getName())) {
+        lastValue = soaElement(arrAlloca, storedType(arrAlloca, arrDecl.get()),
+                               field->index, indexOf(*node.el));
+        return;
+      }
+    }
 
     node.el->accept(*this);
-    // alloca = lastValue;
-    varType = std::static_pointer_cast<TypeArray>(obj_decl->type)->el_type;
+    object = lastValue;
+    varType = elementTypeOf(*node.el);
   }
 
-  if (varType->kind == TYPE_ACCESS) {
-    auto ptrType = std::static_pointer_cast<TypeAccess>(varType);
-    auto classTypeLLVM = ptrType->to->toLLVMType(*context);
-    auto ptrAlloca = builder->CreateLoad(alloca->getAllocatedType(), alloca);
+  // an access keeps a pointer to an object
+  if (varType->kind == TYPE_ACCESS)
+    object = builder->CreateLoad(llvm::PointerType::get(*context, 0), object);
 
-    // construct GEP
+  // inherited fields are in place, see ClassLayout
+  auto classDecl = ownerOf(node);
+  auto field = classDecl ? classDecl->fieldLayout(node.getName()) : nullptr;
+  if (!field) {
     lastValue = builder->CreateStructGEP(
-      classTypeLLVM,
-      ptrAlloca,
-      node.index,
-      node.getName()
-    );
-  } else {
-    auto classTypeLLVM = varType->toLLVMType(*context);
-
-    if (isInherited) {
-      // GEP to class copy
-      lastValue = builder->CreateStructGEP(
-        classTypeLLVM,
-        alloca == nullptr ? lastValue : alloca,
-        0,
-        node.getName()
-      );
-
-      // load class copy
-      // lastValue = builder->CreateLoad(
-      //   classTypeLLVM->getContainedType(0),
-      //   lastValue
-      // );
-
-      // gep to base field
-      // lastValue = builder->CreateStructGEP(
-      //   classTypeLLVM->getContainedType(0),
-      //   lastValue,
-      //   node.index
-      // );
-    }
-    else {
-      // construct GEP
-      lastValue = builder->CreateStructGEP(
-        classTypeLLVM,
-        alloca == nullptr ? lastValue : alloca,
-        node.index,
-        node.getName()
-      );
-    }
+      varType->toLLVMType(*context), object, node.index, node.getName());
+    return;
   }
+
+  lastValue = builder->CreateStructGEP(
+    classDecl->structType,
+    object,
+    field->index,
+    node.getName()
+  );
 }
 
 void CodeGenVisitor::visit(FuncCallEXP &node) {
@@ -293,6 +272,11 @@ void CodeGenVisitor::visit(FuncCallEXP &node) {
     //   );
     // }
 
+    // printf("%s", s), a C function takes bytes of a String
+    if (auto type = typeOf(*Args[i]); CalleeF && CalleeF->isVarArg() &&
+                                      type && type->kind == TYPE_STRING)
+      val = stringBytes(*Args[i], val).first;
+
     ArgsV.push_back(val);
 
     if (!ArgsV.back())
@@ -318,14 +302,34 @@ void CodeGenVisitor::visit(ConstructorCallEXP &node) {
   //   classType = typeTable->getType(moduleName, "Integer");
   // }
 
-  llvm::Type *classType = llvm::StructType::getTypeByName(*context, node.left->getName());
+  // String(), String("text"), String(other), a copy of bytes
+  if (auto type = typeOf(node); type && type->kind == TYPE_STRING) {
+    llvm::Value *bytes = llvm::ConstantPointerNull::get(llvm::PointerType::get(*context, 0));
+    llvm::Value *length = builder->getInt64(0);
+    if (!Args.empty()) {
+      Args[0]->accept(*this);
+      std::tie(bytes, length) = stringBytes(
+          *Args[0], unwrapPointerReference(Args[0].get(), lastValue));
+    }
+    lastValue = builder->CreateCall(stringRuntime("obw_string_new"),
+                                    {bytes, length}, "string");
+    if (!node.escapes)
+      keepString(lastValue);
+    return;
+  }
+
+  auto classDecl = layouts->classOf(node.left->getName());
+  llvm::Type *classType = classDecl ? classDecl->structType : nullptr;
 
   // @TODO
   if (!classType) {
     classType = typeTable->getType(moduleName, "Integer")->toLLVMType(*context);
   }
 
-  auto objInstanceRef = builder->CreateAlloca(classType);
+  auto objInstanceRef = allocateObject(classType, node.escapes,
+                                       classDecl ? classDecl->align : 0);
+  if (classDecl)
+    initVtable(objInstanceRef, *classDecl);
   ArgsV.push_back(objInstanceRef);
 
   std::string typeNames;
@@ -334,7 +338,7 @@ void CodeGenVisitor::visit(ConstructorCallEXP &node) {
     Args[i]->accept(*this);
     ArgsV.push_back(lastValue);
 
-    typeNames += Args[i]->resolveType(typeTable->types[moduleName], currentScope)->name;
+    typeNames += typeOf(*Args[i])->name;
 
     // i wish we could just do
     // ... Args[i]->resolveType()...
@@ -363,23 +367,13 @@ void CodeGenVisitor::visit(ConstructorCallEXP &node) {
 }
 
 void CodeGenVisitor::visit(StringLiteralEXP &node) {
-  std::string processed;
-  for (size_t i = 0; i < node.value.length(); i++) {
-    if (node.value[i] == '\\' && i + 1 < node.value.length()) {
-      switch (node.value[i + 1]) {
-        case 'n': processed += '\n'; break;
-        case 't': processed += '\t'; break;
-        case 'r': processed += '\r'; break;
-        case '\\': processed += '\\'; break;
-        case '"': processed += '"'; break;
-        default: processed += node.value[i + 1]; break;
-      }
-      i++;
-    } else {
-      processed += node.value[i];
-    }
-  }
-  lastValue = builder->CreateGlobalString(processed);
+  // one private unnamed_addr constant per distinct string,
+  // those go to mergeable .rodata.str sections, so a linker
+  // keeps one copy for all modules of a program
+  auto &global = stringLiterals[node.value];
+  if (!global)
+    global = builder->CreateGlobalString(node.value, ".str", 0, module.get());
+  lastValue = global;
 }
 
 void CodeGenVisitor::visit(IntLiteralEXP &node) {
@@ -424,66 +418,88 @@ void CodeGenVisitor::visit(ArrayLiteralExpr &node) {
 
   if(node.el_type == TYPE_UNKNOWN) {
     // resolve type manually
-    elType = node.elements[0]->resolveType(typeTable->types[moduleName], currentScope);
+    elType = typeOf(*node.elements[0]);
   
     //if(elType->kind == 
 
   }
 
   auto arrayTypeLLVM = llvm::ArrayType::get(elType->toLLVMType(*context), node.elements.size());
+  bool inPlace = std::exchange(literalInPlace, false);
 
-  // create constant elements
-  std::vector<llvm::Constant *> elements;
-  for (const auto& el: node.elements) {
-    // auto valToConstant = dyn_cast<llvm::Constant>(cggetval(visit(el)));
+  std::vector<llvm::Value *> elements;
+  for (const auto &el : node.elements) {
     el->accept(*this);
-    auto valToConstant = dyn_cast<llvm::Constant>(lastValue);
-    elements.push_back(valToConstant);
-  }
-
-  // create global array
-  auto constArray = llvm::ConstantArray::get(arrayTypeLLVM, elements);
-  auto globalArray = new llvm::GlobalVariable(
-    *module,
-    arrayTypeLLVM,
-    true,  // isConstant
-    llvm::GlobalValue::LinkageTypes::ExternalLinkage,
-    constArray
-  );
+    elements.push_back(unwrapPointerReference(el.get(), lastValue));
+  }
 
-  // create local array
-  auto localArray = builder->CreateAlloca(arrayTypeLLVM, nullptr);
+  auto global = constantArray(arrayTypeLLVM, elements);
+  if (global && inPlace) {
+    lastValue = global;
+    return;
+  }
 
-  // calc size in bytes
-  auto size = llvm::ConstantInt::get(llvm::Type::getInt64Ty(*context),
-    node.elements.size() * elType->toLLVMType(*context)->getPrimitiveSizeInBits() / 8);
+  // a copy is written to, elements of a constant one at once
+  auto localArray = localAlloca(arrayTypeLLVM, "array");
+  if (global) {
+    auto size = module->getDataLayout().getTypeAllocSize(arrayTypeLLVM);
+    builder->CreateMemCpy(localArray, localArray->getAlign(), global,
+                          global->getAlign(), size);
+  } else {
+    auto i32 = llvm::Type::getInt32Ty(*context);
+    for (size_t i = 0; i < elements.size(); i++) {
+      auto slot = builder->CreateInBoundsGEP(
+          arrayTypeLLVM, localArray,
+          {llvm::ConstantInt::get(i32, 0), llvm::ConstantInt::get(i32, i)});
+      builder->CreateStore(elements[i], slot);
+    }
+  }
 
-  // cast to i8*
-  auto destPtr = builder->CreateBitCast(localArray, llvm::PointerType::get(llvm::Type::getInt8Ty(*context), 0));
-  auto srcPtr = builder->CreateBitCast(globalArray, llvm::PointerType::get(llvm::Type::getInt8Ty(*context), 0));
+  lastValue = localArray;
+}
 
-  // copy data
-  std::vector<llvm::Type*> types = {
-    llvm::PointerType::get(llvm::Type::getInt8Ty(*context), 0),
-    llvm::PointerType::get(llvm::Type::getInt8Ty(*context), 0),
-    llvm::Type::getInt64Ty(*context)
-  };
-  auto memcpyFn = getOrInsertDeclaration(module.get(), llvm::Intrinsic::memcpy, types);
-  builder->CreateCall(memcpyFn, {destPtr, srcPtr, size, llvm::ConstantInt::getFalse(*context)});
+llvm::GlobalVariable *
+CodeGenVisitor::constantArray(llvm::ArrayType *type,
+                              llvm::ArrayRef<llvm::Value *> elements) {
+  std::vector<llvm::Constant *> constants;
+  for (auto element : elements) {
+    auto constant = llvm::dyn_cast<llvm::Constant>(element);
+    if (!constant || constant->getType() != type->getElementType())
+      return nullptr;
+    constants.push_back(constant);
+  }
+
+  // constants are unique in a context, so equal
+  // literals are one pointer and one global
+  auto value = llvm::ConstantArray::get(type, constants);
+  auto &global = constantArrays[value];
+  if (!global) {
+    global = new llvm::GlobalVariable(*module, type, true,
+                                      llvm::GlobalValue::PrivateLinkage,
+                                      value, "array");
+    global->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+    global->setAlignment(module->getDataLayout().getPrefTypeAlign(type));
+  }
+  return global;
+}
 
-  lastValue = localArray;
+void CodeGenVisitor::visit(EnumRefEXP &node) {
+  // items are numbered in order, see EnumDecl::addItem
+  auto enumDecl = currentScope->lookup<EnumDecl>(node.enumName);
+  lastValue = llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context),
+                                     enumDecl->items.at(node.itemName));
 }
 
 void CodeGenVisitor::visit(VarRefEXP &node) {
   // llvm::AllocaInst *alloca = currentScope->lookupAlloca(node.getName()); /* varEnv[node.getName()]; */
   // bool isInited = currentScope->isDeclInitialized(no);
-  auto [_, alloc, isInited] = *currentScope->getSymbol(node.getName());
+  auto [decl, alloc, isInited] = *currentScope->getSymbol(node.getName());
 
   // if (!isInited) {
   //   return alloc;
   // }
 
-  lastValue = builder->CreateLoad(alloc->getAllocatedType(), alloc, node.getName().c_str());
+  lastValue = builder->CreateLoad(storedType(alloc, decl.get()), alloc, node.getName().c_str());
 }
 
 void CodeGenVisitor::visit(BinaryOpEXP &node) {
@@ -495,15 +511,17 @@ void CodeGenVisitor::visit(BinaryOpEXP &node) {
   if (!L || !R)
     return;
 
+  // by --overflow=, as a.Plus(b) is
   switch (node.op) {
   case OP_PLUS:
-    lastValue = builder->CreateAdd(L, R, "addtmp");
+    lastValue = integerArith(llvm::Intrinsic::sadd_with_overflow, L, R, "addtmp");
     break;
   case OP_MINUS:
-    lastValue = builder->CreateSub(L, R, "subtmp");
+    lastValue = integerArith(llvm::Intrinsic::ssub_with_overflow, L, R, "subtmp");
     break;
   case OP_MULTIPLY:
-    lastValue = builder->CreateMul(L, R, "multmp");
+    lastValue = integerArith(llvm::Intrinsic::smul_with_overflow, L, R, "multmp");
+    break;
   case OP_LESS:
     L = builder->CreateFCmpULT(L, R, "cmptmp");
     // Convert bool 0/1 to double 0.0 or 1.0
@@ -524,28 +542,56 @@ void CodeGenVisitor::visit(Decl &node) {
 }
 
 void CodeGenVisitor::visit(ClassDecl &node) {
-  currentScope = currentScope->nextScope();
+  auto enclosingScope = currentScope;
+  currentScope = node.scope;
 
-  auto classType = llvm::StructType::create(*context, llvm::StringRef(node.getName()));
+  // may be laid out already, by a class that uses it
+  layouts->layoutOf(node);
+  if (options.layoutReport)
+    layouts->report(node, llvm::outs());
 
-  auto classSignature = node.type;
-  std::vector<llvm::Type*> fieldTypes;
-  for (auto &field : node.fields) {
-    // add fields types
-    fieldTypes.push_back(field->type->toLLVMType(*context));
+  // inherited methods are compiled once, on a class
+  // that declares them
+  for(auto &method : node.methods) {
+    if (auto methodDecl = std::dynamic_pointer_cast<MethodDecl>(method);
+        methodDecl && methodDecl->isInherited)
+      continue;
+    method->accept(*this);
   }
 
-  classType->setBody(llvm::ArrayRef(fieldTypes));
+  // an instance may be in several object files
+  if (node.isInstance) {
+    for (auto &method : node.methods) {
+      if (auto function = module->getFunction(method->getName()))
+        function->setLinkage(llvm::GlobalValue::LinkOnceODRLinkage);
+    }
+  }
 
-  for(auto &method : node.methods) {
-    method->accept(*this);
+  if (!node.vtable.empty()) {
+    auto ptrType = llvm::PointerType::get(*context, 0);
+    std::vector<llvm::Constant *> slots;
+    for (auto &method : node.vtable) {
+      llvm::Constant *function = getFunction(method->implementation().getName());
+      slots.push_back(function ? function : llvm::ConstantPointerNull::get(ptrType));
+    }
+    auto vtable = vtableOf(node);
+    vtable->setConstant(true);
+    vtable->setInitializer(llvm::ConstantArray::get(
+      llvm::ArrayType::get(ptrType, slots.size()), slots));
+    if (node.isInstance)
+      vtable->setLinkage(llvm::GlobalValue::LinkOnceODRLinkage);
   }
 
-  currentScope = currentScope->prevScope();
+  currentScope = enclosingScope;
 }
 
 void CodeGenVisitor::visit(ConstrDecl &node) {
-  currentScope = currentScope->nextScope();
+  auto enclosingScope = currentScope;
+  currentScope = node.scope;
+
+  // Real operations of a body, restored after it
+  llvm::IRBuilderBase::FastMathFlagGuard fastMathGuard(*builder);
+  builder->setFastMathFlags(fastMathOf(&node));
 
   // CREATE PROTOTYPE OF A FUNCTION
   std::vector<llvm::Type*> argTypes;
@@ -590,15 +636,19 @@ void CodeGenVisitor::visit(ConstrDecl &node) {
   for (auto &el : funcBody->parts) {
     el->accept(*this);
   }
-  builder->CreateRetVoid();
+  emitBodyEnd(true);
 
   verifyFunction(*F);
 
-  currentScope = currentScope->prevScope();
+  currentScope = enclosingScope;
 }
 
 void CodeGenVisitor::visit(MethodDecl &node) {
-  currentScope = currentScope->nextScope();
+  auto enclosingScope = currentScope;
+  currentScope = node.scope;
+
+  llvm::IRBuilderBase::FastMathFlagGuard fastMathGuard(*builder);
+  builder->setFastMathFlags(fastMathOf(&node));
 
   // CREATE PROTOTYPE OF A FUNCTION
   std::vector<llvm::Type*> argTypes;
@@ -643,18 +693,19 @@ void CodeGenVisitor::visit(MethodDecl &node) {
   for (auto &el : methodBody->parts) {
     el->accept(*this);
   }
-
-  if (node.isVoid) {
-    builder->CreateRetVoid();
-  }
+  emitBodyEnd(node.isVoid);
 
   verifyFunction(*F);
 
-  currentScope = currentScope->prevScope();
+  currentScope = enclosingScope;
 }
 
 void CodeGenVisitor::genericMethodDecl(MethodDecl &node) {
-  // currentScope = currentScope->nextScope();
+  auto enclosingScope = currentScope;
+  currentScope = node.scope;
+
+  llvm::IRBuilderBase::FastMathFlagGuard fastMathGuard(*builder);
+  builder->setFastMathFlags(fastMathOf(&node));
 
   // CREATE PROTOTYPE OF A FUNCTION
   std::vector<llvm::Type*> argTypes;
@@ -699,14 +750,11 @@ void CodeGenVisitor::genericMethodDecl(MethodDecl &node) {
   for (auto &el : methodBody->parts) {
     el->accept(*this);
   }
-
-  if (node.isVoid) {
-    builder->CreateRetVoid();
-  }
+  emitBodyEnd(node.isVoid);
 
   verifyFunction(*F);
 
-  currentScope = currentScope->prevScope();
+  currentScope = enclosingScope;
 }
 
 void CodeGenVisitor::visit(FieldDecl &node) {
@@ -714,10 +762,7 @@ void CodeGenVisitor::visit(FieldDecl &node) {
 }
 
 void CodeGenVisitor::visit(ModuleDecl &node) {
-  currentScope = currentScope->nextScope(); // global scope -> module scope
-
-  while (currentScope->getKind() != SCOPE_MODULE
-    && currentScope->getName() != node.getName()) currentScope = currentScope->nextScope();
+  currentScope = node.scope; // global scope -> module scope
 
   auto children = node.children;
   for (const auto &child : children) {
@@ -725,15 +770,20 @@ void CodeGenVisitor::visit(ModuleDecl &node) {
   }
 
   // Create MAIN() that will call Main class constructor !
-  auto mainType = llvm::StructType::getTypeByName(*context, "Main");
-  if (mainType) {
+  auto mainDecl = std::ranges::find_if(children, [](const auto &child) {
+    return child->getKind() == E_Class_Decl && child->getName() == "Main";
+  });
+  if (mainDecl != children.end()) {
+    auto mainClass = layouts->classOf("Main");
     llvm::FunctionType *FT = llvm::FunctionType::get(llvm::Type::getInt32Ty(*context), false);
     llvm::Function *F = llvm::Function::Create(FT, llvm::Function::ExternalLinkage, "main", module.get());
 
     llvm::BasicBlock *BB = llvm::BasicBlock::Create(*context, "entry", F);
     builder->SetInsertPoint(BB);
 
-    auto mainAlloca = builder->CreateAlloca(mainType);
+    auto mainAlloca = allocateObject(mainClass->structType, false,
+                                     mainClass->align);
+    initVtable(mainAlloca, *mainClass);
 
     auto mainConstr = getFunction("Main_Create");
     builder->CreateCall(mainConstr, {mainAlloca});
@@ -751,33 +801,52 @@ void CodeGenVisitor::visit(VarDecl &node) {
 
   std::string var_name = node.getName();
   auto varType = node.type->toLLVMType(*this->context);
+  if (auto classDecl = soaClassOf(&node)) {
+    auto size = std::static_pointer_cast<TypeArray>(node.type)->size;
+    varType = layouts->soaOf(*classDecl, size);
+  }
   auto initializer = node.initializer;
-  llvm::AllocaInst *alloca;
+  llvm::Value *alloca;
   llvm::Value* initVal;
   if (initializer) {
+    // a literal of an array nothing writes to stays a
+    // constant global, see VarDecl::isModified
+    literalInPlace =
+        initializer->getKind() == E_Array_Literal && !node.isModified;
     initializer->accept(*this);
     initVal = lastValue;
-    if (initializer->getKind() != E_Constructor_Call && initializer->getKind() != E_Array_Literal) {
+    // an object or an array is its own storage, a String is a pointer
+    auto initType = typeOf(*initializer);
+    bool isStorage = initializer->getKind() == E_Array_Literal ||
+                     (initializer->getKind() == E_Constructor_Call &&
+                      !(initType && initType->kind == TYPE_STRING));
+    if (!isStorage) {
 
       // if initVal is a pointer (EL_REF, GEP)
       llvm::Value* initValUnwrap = unwrapPointerReference(initializer.get(), initVal);
 
-      alloca = builder->CreateAlloca(varType, nullptr, var_name);
+      alloca = localAlloca(varType, var_name);
       builder->CreateStore(initValUnwrap, alloca);
+      restoreVtable(alloca, varType);
     } else {
       // For constructor calls, we already have the allocation
-      alloca = dyn_cast<llvm::AllocaInst>(initVal);
+      // (an alloca or a heap object)
+      alloca = initVal;
     }
   }
   else {
-    alloca = builder->CreateAlloca(varType, nullptr, var_name);
+    alloca = localAlloca(varType, var_name);
   }
 
   currentScope->addSymbol(var_name, alloca);
 }
 
 void CodeGenVisitor::visit(FuncDecl &node) {
-  currentScope = currentScope->nextScope();
+  auto enclosingScope = currentScope;
+  currentScope = node.scope;
+
+  llvm::IRBuilderBase::FastMathFlagGuard fastMathGuard(*builder);
+  builder->setFastMathFlags(fastMathOf(&node));
 
   // CREATE PROTOTYPE OF A FUNCTION
   std::vector<llvm::Type*> argTypes;
@@ -823,14 +892,11 @@ void CodeGenVisitor::visit(FuncDecl &node) {
   for (auto &el : funcBody->parts) {
     el->accept(*this);
   }
-
-  if (node.isVoid) {
-    builder->CreateRetVoid();
-  }
+  emitBodyEnd(node.isVoid);
 
   verifyFunction(*F);
 
-  currentScope = currentScope->prevScope();
+  currentScope = enclosingScope;
 };
 
 
@@ -843,12 +909,21 @@ void CodeGenVisitor::visit(Statement &node) {
 }
 
 void CodeGenVisitor::visit(IfSTMT &node) {
-  currentScope = currentScope->nextScope();
+  auto enclosingScope = currentScope;
+  currentScope = node.scope;
+
+  if (auto arms = switchArmsOf(node); !arms.empty()) {
+    auto subject = std::static_pointer_cast<MethodCallEXP>(node.condition);
+    if (emitSwitch(*subject->left, arms)) {
+      currentScope = enclosingScope;
+      return;
+    }
+  }
 
   // gen condition first startCode
   node.condition->accept(*this);
   auto startCode = lastValue;
-  auto type = node.condition->resolveType(typeTable->types[moduleName], currentScope);
+  auto type = typeOf(*node.condition);
 
   llvm::Function *TheFunction = builder->GetInsertBlock()->getParent();
 
@@ -864,12 +939,11 @@ void CodeGenVisitor::visit(IfSTMT &node) {
 
   // if True body
   // volatile auto thenCode = visit(node->ifTrue);
-  auto trueBody = node.ifTrue;
-  for (auto &part : trueBody->parts) {
-    part->accept(*this);
-  }
+  emitBlock(*node.ifTrue);
 
-  builder->CreateBr(MergeBB);
+  // a return leaves an if from a branch
+  if (!builder->GetInsertBlock()->getTerminator())
+    builder->CreateBr(MergeBB);
 
   ThenBB = builder->GetInsertBlock();
 
@@ -887,7 +961,8 @@ void CodeGenVisitor::visit(IfSTMT &node) {
     // }
   }
 
-  builder->CreateBr(MergeBB);
+  if (!builder->GetInsertBlock()->getTerminator())
+    builder->CreateBr(MergeBB);
   // codegen of 'Else' can change the current block, update ElseBB for the PHI.
   ElseBB = builder->GetInsertBlock();
 
@@ -895,72 +970,18 @@ void CodeGenVisitor::visit(IfSTMT &node) {
   TheFunction->insert(TheFunction->end(), MergeBB);
   builder->SetInsertPoint(MergeBB);
 
-  currentScope = currentScope->prevScope();
+  currentScope = enclosingScope;
 }
 
 void CodeGenVisitor::visit(ForSTMT &node) {
-  currentScope = currentScope->nextScope();
-
-  // initial assignment startCode
-  node.varWithAss->accept(*this);
+  auto enclosingScope = currentScope;
+  currentScope = node.scope;
 
-  // get loop variable
-  auto iteratorVar = node.varWithAss;
-  auto [iterDecl, iterAlloca, iterInited] = *currentScope->getSymbol<VarDecl>(iteratorVar->getName());
-  auto iteratorType = iterDecl->type;
-  auto iterTypeLLVM = iteratorType->toLLVMType(*this->context);
+  // the variable is declared before a loop, only
+  // checked and stepped by it, see Parser::parseForStatement
+  emitLoop(*node.condition, node.body.get(), node.post.get(), node.hints);
 
-  // loop header block
-  llvm::Function *TheFunction = builder->GetInsertBlock()->getParent();
-  llvm::BasicBlock *PreheaderBB = builder->GetInsertBlock();
-  llvm::BasicBlock *LoopBB = llvm::BasicBlock::Create(*context, "loop", TheFunction);
-  llvm::BasicBlock *AfterBB = llvm::BasicBlock::Create(*context, "afterloop", TheFunction);
-
-  // load value for phi node
-  auto initialValue = builder->CreateLoad(iterTypeLLVM, iterAlloca);
-
-  // Branch _> header
-  builder->CreateBr(LoopBB);
-
-  // start insertion -> LoopBB
-  builder->SetInsertPoint(LoopBB);
-
-  // Create the PHI node <= the loop variable
-  llvm::PHINode *Variable = builder->CreatePHI(iterTypeLLVM, 2, iteratorVar->getName());
-
-  // add the initial value from the
-  Variable->addIncoming(initialValue, PreheaderBB);
-
-  // store the phi node value back to the alloca
-  builder->CreateStore(Variable, iterAlloca);
-
-  // generate loop body
-  // volatile auto bodyCode = visitDefault(node->body);
-  auto forBody = node.body;
-  for (auto &el : forBody->parts) {
-    el->accept(*this);
-  }
-
-  // Generate step code stepCode
-  node.post->accept(*this);
-
-  // Load the current value after the step
-  auto currentValue = builder->CreateLoad(iterTypeLLVM, iterAlloca);
-
-  // Generate condition condCode
-  node.condition->accept(*this);
-  auto condCode = lastValue;
-
-  // Add the current value as incoming to phi node
-  Variable->addIncoming(currentValue, builder->GetInsertBlock());
-
-  // Create conditional branch
-  builder->CreateCondBr(condCode, LoopBB, AfterBB);
-
-  // Start insertion in AfterBB
-  builder->SetInsertPoint(AfterBB);
-
-  currentScope = currentScope->prevScope();
+  currentScope = enclosingScope;
 }
 
 void CodeGenVisitor::visit(AssignmentSTMT &node) {
@@ -980,28 +1001,48 @@ void CodeGenVisitor::visit(AssignmentSTMT &node) {
     var = lastValue;
     name = node.field->getName();
     break;
-  case EL_ASS:
+  case EL_ASS: {
+    // fields of an object go to arrays of a soa one by one
+    auto [arrDecl, arrAlloca, arrInited] = *currentScope->getSymbol(node.element->arr->getName());
+    if (auto classDecl = soaClassOf(arrDecl.get())) {
+      auto index = indexOf(*node.element);
+      node.expression->accept(*this);
+      auto object = lastValue;
+      if (!object->getType()->isPointerTy()) {
+        auto copy = localAlloca(classDecl->structType, "element");
+        builder->CreateStore(object, copy);
+        object = copy;
+      }
+      scatterElement(*classDecl, arrAlloca, storedType(arrAlloca, arrDecl.get()),
+                     index, object);
+      return;
+    }
+
     // var = cggetval(visit(node->element));
     node.element->accept(*this);
     var = lastValue;
     // name = node->element->; @TODO
     break;
   }
+  }
 
-  // llvm::Value *assignment = cggetval(visit(node->expression));
+  // a constant literal is copied straight from its global
+  literalInPlace = node.expression->getKind() == E_Array_Literal;
   node.expression->accept(*this);
-  // llvm::Value* assignment = lastValue;
-
-  // addition
-  if (lastValue->getType()->isPointerTy()) {
-    std::vector<llvm::Type*> types = {
-      llvm::PointerType::get(llvm::Type::getInt8Ty(*context), 0),
-      llvm::PointerType::get(llvm::Type::getInt8Ty(*context), 0),
-      llvm::Type::getInt64Ty(*context)
-    };
-    llvm::Value* sizeOf = getSizeOfValue(lastValue);
-    auto memcpyFn = getOrInsertDeclaration(module.get(), llvm::Intrinsic::memcpy, types);
-    builder->CreateCall(memcpyFn, {var, lastValue, sizeOf, llvm::ConstantInt::getFalse(*context)});
+  literalInPlace = false;
+
+  // a pointer to an object or an array is copied from, a pointer
+  // to a scalar (a field, an element) or an access is a value
+  auto type = assignedType(node, var);
+  if (lastValue->getType()->isPointerTy() && type->isAggregateType()) {
+    emitCopy(var, lastValue, type);
+
+    // a temporary is dead after it, so the copy
+    // may be folded into stores of its elements
+    auto temporary = llvm::dyn_cast<llvm::AllocaInst>(lastValue);
+    if (temporary && node.expression->getKind() == E_Array_Literal &&
+        !blockLocals.empty() && std::erase(blockLocals.back(), temporary))
+      builder->CreateLifetimeEnd(temporary, sizeOf(type));
   }
   else {
     auto assignment = unwrapPointerReference(node.expression.get(), lastValue);
@@ -1011,14 +1052,16 @@ void CodeGenVisitor::visit(AssignmentSTMT &node) {
 }
 
 void CodeGenVisitor::visit(ReturnSTMT &node) {
-  // @TODO: className + ...
-  auto methodName = currentScope->getName();
-  auto methodDecl =currentScope->lookup<MethodDecl>(methodName);
-
+  if (!node.expr) {
+    builder->CreateRetVoid();
+    return;
+  }
   node.expr->accept(*this);
   llvm::Value *retVal = lastValue;
 
-  auto returnType = methodDecl->signature->return_type->toLLVMType(*context);
+  // a return may be in a loop or an if, whose scope is not
+  // one of a method, a function being emitted knows its type
+  auto returnType = builder->GetInsertBlock()->getParent()->getReturnType();
   if (retVal && retVal->getType()->isPointerTy()) {
     if (!returnType->isPointerTy()) {
       // Load the value from the pointer
@@ -1033,11 +1076,7 @@ void CodeGenVisitor::visit(ReturnSTMT &node) {
 //#####=============== COMPILING ===============#####
 //#####=========================================#####
 
-void CodeGenVisitor::createObjFile() {
-  // LINK MODULES
-
-  // ============
-
+void CodeGenVisitor::initTarget() {
   llvm::InitializeAllTargetInfos();
   llvm::InitializeAllTargets();
   llvm::InitializeAllTargetMCs();
@@ -1064,10 +1103,48 @@ void CodeGenVisitor::createObjFile() {
   auto Features = "";
 
   llvm::TargetOptions opt;
-  auto TheTargetMachine = Target->createTargetMachine(
-      llvm::Triple(TargetTriple).str(), CPU, Features, opt, llvm::Reloc::PIC_);
+  targetMachine.reset(Target->createTargetMachine(
+      llvm::Triple(TargetTriple).str(), CPU, Features, opt, llvm::Reloc::PIC_));
+
+  // class layouts take sizes from it, so before any codegen
+  module->setDataLayout(targetMachine->createDataLayout());
+}
 
-  module->setDataLayout(TheTargetMachine->createDataLayout());
+void CodeGenVisitor::optimize() {
+  if (!options.optLevel || !targetMachine)
+    return;
+
+  llvm::LoopAnalysisManager loopAM;
+  llvm::FunctionAnalysisManager functionAM;
+  llvm::CGSCCAnalysisManager cgsccAM;
+  llvm::ModuleAnalysisManager moduleAM;
+
+  llvm::PassBuilder passBuilder(targetMachine.get());
+  passBuilder.registerModuleAnalyses(moduleAM);
+  passBuilder.registerCGSCCAnalyses(cgsccAM);
+  passBuilder.registerFunctionAnalyses(functionAM);
+  passBuilder.registerLoopAnalyses(loopAM);
+  passBuilder.crossRegisterProxies(loopAM, functionAM, cgsccAM, moduleAM);
+
+  static const llvm::OptimizationLevel levels[] = {
+      llvm::OptimizationLevel::O0, llvm::OptimizationLevel::O1,
+      llvm::OptimizationLevel::O2, llvm::OptimizationLevel::O3};
+  // a context is shared by modules, its own handler is back after
+  auto previous = context->getDiagnosticHandler();
+  context->setDiagnosticHandler(std::make_unique<LoopHintHandler>(moduleName));
+  auto pipeline = passBuilder.buildPerModuleDefaultPipeline(
+      levels[std::min(options.optLevel, 3u)]);
+  pipeline.run(*module, moduleAM);
+  context->setDiagnosticHandler(std::move(previous));
+}
+
+void CodeGenVisitor::createObjFile() {
+  // LINK MODULES
+
+  // ============
+
+  if (!targetMachine)
+    return;
 
   auto Filename = moduleName + ".o";
   std::error_code EC;
@@ -1081,7 +1158,7 @@ void CodeGenVisitor::createObjFile() {
   llvm::legacy::PassManager pass;
   auto FileType = llvm::CodeGenFileType::ObjectFile;
 
-  if (TheTargetMachine->addPassesToEmitFile(pass, dest, nullptr, FileType)) {
+  if (targetMachine->addPassesToEmitFile(pass, dest, nullptr, FileType)) {
     llvm::errs() << "TheTargetMachine can't emit a file of this type";
     return;
   }
@@ -1091,6 +1168,7 @@ void CodeGenVisitor::createObjFile() {
     exit(-1);
     // Handle error
   }
+  optimize();
 
   pass.run(*module);
   dest.flush();
@@ -1099,6 +1177,9 @@ void CodeGenVisitor::createObjFile() {
 
   // clang linking
   std::string command = "clang -o "+ Filename + "out " +  Filename + " ";
+#ifdef OBW_RUNTIME_LIB
+  command += OBW_RUNTIME_LIB;
+#endif
   int status = system(command.c_str());
   if (status == -1) {
     CG_ERR("", "Linking failed");
@@ -1138,6 +1219,90 @@ llvm::AllocaInst *CodeGenVisitor::createEntryBlockAlloca(llvm::Function *TheFunc
                            VarName);
 }
 
+llvm::AllocaInst *CodeGenVisitor::localAlloca(llvm::Type *type,
+                                              const llvm::Twine &name) {
+  auto function = builder->GetInsertBlock()->getParent();
+  auto slot = createEntryBlockAlloca(function, type, name.str());
+  auto size = module->getDataLayout().getTypeAllocSize(type);
+  builder->CreateLifetimeStart(slot, builder->getInt64(size));
+  if (!blockLocals.empty())
+    blockLocals.back().push_back(slot);
+  return slot;
+}
+
+// a body may end in a return already, or in
+// a block after an if whose branches both return
+void CodeGenVisitor::emitBodyEnd(bool isVoid) {
+  if (!builder->GetInsertBlock()->getTerminator()) {
+    if (isVoid)
+      builder->CreateRetVoid();
+    else
+      builder->CreateUnreachable();
+  }
+  freeStrings(*builder->GetInsertBlock()->getParent());
+}
+
+void CodeGenVisitor::emitBlock(Block &block) {
+  blockLocals.emplace_back();
+  for (auto &part : block.parts)
+    part->accept(*this);
+
+  // a return ended a block already
+  if (!builder->GetInsertBlock()->getTerminator()) {
+    auto &dataLayout = module->getDataLayout();
+    for (auto slot : blockLocals.back()) {
+      auto size = dataLayout.getTypeAllocSize(slot->getAllocatedType());
+      builder->CreateLifetimeEnd(slot, builder->getInt64(size));
+    }
+  }
+  blockLocals.pop_back();
+}
+
+llvm::Type *CodeGenVisitor::storedType(llvm::Value *slot, const Entity *decl) {
+  if (auto alloca = llvm::dyn_cast<llvm::AllocaInst>(slot))
+    return alloca->getAllocatedType();
+  if (auto global = llvm::dyn_cast<llvm::GlobalVariable>(slot))
+    return global->getValueType();
+
+  std::shared_ptr<Type> type;
+  if (decl && decl->getKind() == E_Variable_Decl)
+    type = static_cast<const VarDecl *>(decl)->type;
+  else if (decl && decl->getKind() == E_Parameter_Decl)
+    type = static_cast<const ParameterDecl *>(decl)->type;
+  assert(type && "Slot of an unknown type");
+  return type->toLLVMType(*context);
+}
+
+llvm::Value *CodeGenVisitor::allocateObject(llvm::Type *type, bool escapes,
+                                            uint64_t align) {
+  if (!escapes) {
+    // one slot per call site, reused by every execution of it,
+    // no lifetime markers: an access local declared outside
+    // a block may keep an object of it (see EscapeAnalysis)
+    auto function = builder->GetInsertBlock()->getParent();
+    auto slot = createEntryBlockAlloca(function, type, "obj");
+    if (align > slot->getAlign().value())
+      slot->setAlignment(llvm::Align(align));
+    return slot;
+  }
+
+  auto size = sizeOf(type);
+  // malloc is aligned for builtin types only, size
+  // of an align(N) class is a multiple of N already
+  if (align > maxMallocAlign) {
+    auto i64 = llvm::Type::getInt64Ty(*context);
+    auto alignedAlloc = module->getOrInsertFunction(
+      "aligned_alloc", llvm::PointerType::get(*context, 0), i64, i64);
+    return builder->CreateCall(alignedAlloc,
+      {llvm::ConstantInt::get(i64, align), size}, "obj");
+  }
+  // malloc is declared up front, another one on first use
+  auto allocator = module->getOrInsertFunction(
+    options.allocator, llvm::PointerType::get(*context, 0),
+    llvm::Type::getInt64Ty(*context));
+  return builder->CreateCall(allocator, {size}, "obj");
+}
+
 // llvm::StructType* CodeGenVisitor::getStructType(const std::string &name) {
 //   auto allStructs = module->getIdentifiedStructTypes();
 //   auto namedStruct = std::find_if(
@@ -1153,9 +1318,9 @@ llvm::AllocaInst *CodeGenVisitor::createEntryBlockAlloca(llvm::Function *TheFunc
 //#####=========================================#####
 //#####=========================================#####
 
-void CodeGenVisitor::handleBuiltinMethodCall(
-    MethodCallEXP &node,
-    std::string methodName) {
+void CodeGenVisitor::handleBuiltinMethodCall(MethodCallEXP &node,
+                                             BuiltinMethod method,
+                                             TypeKind receiver) {
 
   // get left operand
   node.left->accept(*this);
@@ -1163,154 +1328,267 @@ void CodeGenVisitor::handleBuiltinMethodCall(
   if (!L)
     return;
 
-  // only one arg for builtin methods
-  // if (node->arguments.size() != 1) {
-  //   return cgnone;
-  // }
-
   // get right operand (can be void) ?
-  llvm::Value *R;
+  llvm::Value *R = nullptr;
   if (!node.arguments.empty()) {
     node.arguments[0]->accept(*this);
     R = unwrapPointerReference(node.arguments[0].get(), lastValue);
-    // if (!R)
-    //   return cgnone;
   }
 
-  auto leftType = node.left->resolveType(typeTable->types[moduleName], currentScope);
-  auto className = leftType->name;
-
   // handle different methods
-  if (methodName == "Size") {
-    llvm::Type* type = L->getType();
-    llvm::Value* nullValue = llvm::ConstantPointerNull::get(llvm::PointerType::get(type, 0));
-    llvm::Value* offset = builder->CreateGEP(type, nullValue, llvm::ConstantInt::get(*context, llvm::APInt(16, 1)));
-    lastValue = builder->CreatePtrToInt(offset, llvm::Type::getInt64Ty(*context), "typeSize");
+  if (method == BM_SIZE && receiver != TYPE_STRING) {
+    lastValue = sizeOf(L->getType());
     return;
   }
-  if (className == "Integer" or className == "i64") {
-    handleIntegerMethods(methodName, L, R);
-  }
-  else if (className == "Real") {
-    handleRealMethods(methodName, L, R);
-  }
-  else if (className == "Boolean") {
-    handleBooleanMethods(methodName, L, R);
+
+  switch (receiver) {
+  case TYPE_INT:
+  case TYPE_I64:
+    handleIntegerMethods(method, L, R);
+    break;
+  case TYPE_REAL:
+    handleRealMethods(method, L, R);
+    break;
+  case TYPE_BOOL:
+    handleBooleanMethods(method, L, R);
+    break;
+  case TYPE_STRING:
+    handleStringMethods(method, L,
+                        node.arguments.empty() ? nullptr
+                                               : node.arguments[0].get(),
+                        R);
+    break;
+  default:
+    break;
   }
 }
 
-void CodeGenVisitor::handleIntegerMethods(const std::string &methodName, llvm::Value* L, llvm::Value *R) {
-  if (methodName == "Plus") {
-    lastValue = builder->CreateAdd(L, R, "addtmp");
+void CodeGenVisitor::handleStringMethods(BuiltinMethod method, llvm::Value *L,
+                                         Expression *arg, llvm::Value *R) {
+  if (method == BM_SIZE) {
+    lastValue = builder->CreateLoad(builder->getInt64Ty(),
+                                    builder->CreateStructGEP(stringHead(), L, 0),
+                                    "length");
+    return;
   }
-  else if (methodName == "Minus") {
-      lastValue = builder->CreateSub(L, R, "subtmp");
+  if (!arg || !R)
+    return;
+
+  switch (method) {
+  case BM_APPEND: {
+    auto [bytes, length] = stringBytes(*arg, R);
+    lastValue = builder->CreateCall(stringRuntime("obw_string_append"),
+                                    {L, bytes, length});
+  } break;
+  case BM_PUSH:
+    lastValue = builder->CreateCall(
+        stringRuntime("obw_string_push"),
+        {L, builder->CreateIntCast(R, builder->getInt8Ty(), true)});
+    break;
+  case BM_CONCAT: {
+    auto [bytes, length] = stringBytes(*arg, R);
+    lastValue = builder->CreateCall(stringRuntime("obw_string_concat_bytes"),
+                                    {L, bytes, length}, "concat");
+  } break;
+  case BM_EQUAL: {
+    auto [bytes, length] = stringBytes(*arg, R);
+    lastValue = builder->CreateCall(stringRuntime("obw_string_equal_bytes"),
+                                    {L, bytes, length}, "equal");
+  } break;
+  default:
+    break;
   }
-  else if (methodName == "Mult") {
-    lastValue = builder->CreateMul(L, R, "multmp");
+}
+
+llvm::Value *CodeGenVisitor::integerArith(llvm::Intrinsic::ID op,
+                                          llvm::Value *L, llvm::Value *R,
+                                          const llvm::Twine &name) {
+  bool nsw = options.overflow == OVERFLOW_UNDEFINED;
+  if (options.overflow != OVERFLOW_TRAP) {
+    switch (op) {
+    case llvm::Intrinsic::sadd_with_overflow:
+      return builder->CreateAdd(L, R, name, false, nsw);
+    case llvm::Intrinsic::ssub_with_overflow:
+      return builder->CreateSub(L, R, name, false, nsw);
+    default:
+      return builder->CreateMul(L, R, name, false, nsw);
+    }
   }
-  else if (methodName == "Div") {
+
+  // { result, overflowed }, optimizer drops checks it proves
+  auto arith = llvm::Intrinsic::getOrInsertDeclaration(module.get(), op,
+                                                       {L->getType()});
+  auto checked = builder->CreateCall(arith, {L, R});
+  auto overflowed = builder->CreateExtractValue(checked, 1, "overflowed");
+
+  auto function = builder->GetInsertBlock()->getParent();
+  auto trapBB = llvm::BasicBlock::Create(*context, "overflow", function);
+  auto contBB = llvm::BasicBlock::Create(*context, "nooverflow", function);
+  builder->CreateCondBr(overflowed, trapBB, contBB);
+
+  builder->SetInsertPoint(trapBB);
+  builder->CreateCall(llvm::Intrinsic::getOrInsertDeclaration(
+      module.get(), llvm::Intrinsic::trap));
+  builder->CreateUnreachable();
+
+  builder->SetInsertPoint(contBB);
+  return builder->CreateExtractValue(checked, 0, name);
+}
+
+llvm::FastMathFlags CodeGenVisitor::fastMathOf(const Decl *decl) const {
+  auto has = [&](bool option, const char *name) {
+    return option || (decl && decl->attribute(name));
+  };
+  llvm::FastMathFlags flags;
+  if (has(options.fastMath.fast, "fast_math"))
+    flags.setFast();
+  if (has(options.fastMath.reassoc, "reassoc"))
+    flags.setAllowReassoc();
+  if (has(options.fastMath.contract, "contract"))
+    flags.setAllowContract(true);
+  if (has(options.fastMath.noNaNs, "nnan"))
+    flags.setNoNaNs();
+  if (has(options.fastMath.noInfs, "ninf"))
+    flags.setNoInfs();
+  return flags;
+}
+
+void CodeGenVisitor::handleIntegerMethods(BuiltinMethod method, llvm::Value* L, llvm::Value *R) {
+  switch (method) {
+  case BM_PLUS:
+    lastValue = integerArith(llvm::Intrinsic::sadd_with_overflow, L, R, "addtmp");
+    break;
+  case BM_MINUS:
+    lastValue = integerArith(llvm::Intrinsic::ssub_with_overflow, L, R, "subtmp");
+    break;
+  case BM_MULT:
+    lastValue = integerArith(llvm::Intrinsic::smul_with_overflow, L, R, "multmp");
+    break;
+  case BM_DIV:
     lastValue = builder->CreateSDiv(L, R, "divtmp");
-  }
-  else if (methodName == "Rem") {
+    break;
+  case BM_REM:
     lastValue = builder->CreateSRem(L, R, "remtmp");
-  }
-  else if (methodName == "Less") {
+    break;
+  case BM_LESS:
     lastValue = builder->CreateICmpSLT(L, R, "cmptmp");
-  }
-  else if (methodName == "Greater") {
+    break;
+  case BM_GREATER:
     lastValue = builder->CreateICmpSGT(L, R, "cmptmp");
-  }
-  else if (methodName == "Equal") {
+    break;
+  case BM_EQUAL:
     lastValue = builder->CreateICmpEQ(L, R, "cmptmp");
-  }
-  else if (methodName == "UnaryMinus") {
-    auto one = llvm::ConstantInt::getSigned((llvm::Type::getInt32Ty(*context)), -1);
-    lastValue = builder->CreateMul(L, one, "uminus");
+    break;
+  case BM_UNARY_MINUS:
+    // 0 - x, -MIN is the only one to overflow
+    if (options.overflow == OVERFLOW_TRAP)
+      lastValue = integerArith(llvm::Intrinsic::ssub_with_overflow,
+                               llvm::ConstantInt::get(L->getType(), 0), L,
+                               "uminus");
+    else if (options.overflow == OVERFLOW_UNDEFINED)
+      lastValue = builder->CreateNSWNeg(L, "uminus");
+    else
+      lastValue = builder->CreateNeg(L, "uminus");
+    break;
+  default:
+    break;
   }
 }
 
-void CodeGenVisitor::handleRealMethods(const std::string &methodName, llvm::Value* L, llvm::Value *R) {
-  if (methodName == "Plus") {
+void CodeGenVisitor::handleRealMethods(BuiltinMethod method, llvm::Value* L, llvm::Value *R) {
+  switch (method) {
+  case BM_PLUS:
     lastValue = builder->CreateFAdd(L, R, "faddtmp");
-  }
-  else if (methodName == "Minus") {
+    break;
+  case BM_MINUS:
     lastValue = builder->CreateFSub(L, R, "fsubtmp");
-  }
-  else if (methodName == "Mult") {
+    break;
+  case BM_MULT:
     lastValue = builder->CreateFMul(L, R, "fmultmp");
-  }
-  else if (methodName == "Div") {
+    break;
+  case BM_DIV:
     lastValue = builder->CreateFDiv(L, R, "fdivtmp");
-  }
-  else if (methodName == "Rem") {
+    break;
+  case BM_REM:
     lastValue = builder->CreateFRem(L, R, "fremtmp");
-  }
-  else if (methodName == "Less") {
+    break;
+  case BM_LESS:
     lastValue = builder->CreateFCmpOLT(L, R, "fcmptmp");
-  }
-  else if (methodName == "Greater") {
+    break;
+  case BM_GREATER:
     lastValue = builder->CreateFCmpOGT(L, R, "fcmptmp");
-  }
-  else if (methodName == "Equal") {
+    break;
+  case BM_EQUAL:
     lastValue = builder->CreateFCmpOEQ(L, R, "fcmptmp");
-  }
-  else if (methodName == "UnaryMinus") {
-    auto negOne = llvm::ConstantFP::get(llvm::Type::getFloatTy(*context), -1.0);
-    lastValue = builder->CreateFMul(L, negOne, "fuminus");
+    break;
+  case BM_UNARY_MINUS:
+    lastValue = builder->CreateFNeg(L, "fuminus");
+    break;
+  default:
+    break;
   }
 }
 
-void CodeGenVisitor::handleBooleanMethods(const std::string &methodName, llvm::Value* L, llvm::Value *R) {
-  if (moduleName == "And") {
+void CodeGenVisitor::handleBooleanMethods(BuiltinMethod method, llvm::Value* L, llvm::Value *R) {
+  switch (method) {
+  case BM_AND:
     lastValue = builder->CreateAnd(L, R, "andtmp");
-  }
-  else if (methodName == "Or") {
+    break;
+  case BM_OR:
     lastValue = builder->CreateOr(L, R, "ortmp");
-  }
-  else if (methodName == "Not") {
+    break;
+  case BM_NOT:
     lastValue = builder->CreateNot(L, "nottemp");
-  }
-  else if (methodName == "Equal") {
+    break;
+  case BM_EQUAL:
     lastValue = builder->CreateICmpEQ(L, R, "cmptmp");
+    break;
+  default:
+    break;
   }
 }
 
 void CodeGenVisitor::visit(MethodCallEXP &node) {
-  // check if this is a built-in method call
-  std::string className;
-  if (node.left->getKind() == E_Var_Reference) {
-    auto leftDecl = currentScope->lookup<VarDecl>(node.left->getName());
-    className = leftDecl->type->name;
-  }
-  else if (node.left->getKind() == E_Integer_Literal) {
-    auto intRefLeft = std::static_pointer_cast<IntLiteralEXP>(node.left);
-    auto leftDecl = currentScope->lookup<VarDecl>(
-      std::to_string(intRefLeft->getValue()));
-    className = leftDecl->type->name;
-  }
-
-  // @TODO optimize
-  std::shared_ptr<MethodDecl> decl;
-  for (auto child : globalScope->getChildren()) {
-    if (child->getKind() == SCOPE_MODULE_BUILTIN) {
-      auto classBTScope = child->getChildren()[0]; // ? single module - single class : Integer - Integer
-      decl =
-        classBTScope->lookup<MethodDecl>(node.getName());
-      if (decl) break;
+  // Point.Size(), T.Size() of an instance of a template,
+  // a size of a type itself is a constant
+  if (node.left->getKind() == E_Class_Name && node.getName() == "Size") {
+    auto type = typeOf(*node.left);
+    if (type && type->kind == TYPE_CLASS)
+      layouts->classOf(type->name);
+    if (auto llvmType = type ? type->toLLVMType(*context) : nullptr;
+        llvmType && llvmType->isSized()) {
+      lastValue = sizeOf(llvmType);
+      return;
     }
   }
 
-  if (decl && decl->getKind() == E_Method_Decl) {
-    if (decl->isBuiltin) {
-      return handleBuiltinMethodCall(node, node.getName());
+  // builtin methods are resolved by (receiver type, method id)
+  if (auto method = lookupBuiltinMethod(node.getName()); method != BM_NONE) {
+    auto leftType = typeOf(*node.left);
+    if (leftType && findBuiltin(leftType->kind, method))
+      return handleBuiltinMethodCall(node, method, leftType->kind);
+  }
+
+  auto [decl, alloc, isInited] = *currentScope->getSymbol(node.left->getName());
+
+  // 'this' is an object itself, or a pointer kept by
+  // an access variable, static methods just never read it
+  std::string className;
+  llvm::Value *self = alloc;
+  if (node.left->getKind() == E_Class_Name) {
+    className = node.left->getName();
+    self = llvm::ConstantPointerNull::get(llvm::PointerType::get(*context, 0));
+  } else {
+    auto leftType = typeOf(*node.left);
+    className = leftType->name;
+    if (leftType->kind == TYPE_ACCESS) {
+      className = std::static_pointer_cast<TypeAccess>(leftType)->to->name;
+      self = builder->CreateLoad(storedType(alloc, decl.get()), alloc);
     }
   }
 
-  auto varRef = std::static_pointer_cast<VarRefEXP>(node.left);
-  auto [_, alloc, isInited] = *currentScope->getSymbol(varRef->getName());
   std::vector<llvm::Value *> ArgsV;
-  ArgsV.push_back(alloc); // Pass the pointer directly as 'this'
+  ArgsV.push_back(self); // Pass the pointer directly as 'this'
 
   for (unsigned i = 0, e = node.arguments.size(); i != e; ++i) {
     node.arguments[i]->accept(*this);
@@ -1321,39 +1599,294 @@ void CodeGenVisitor::visit(MethodCallEXP &node) {
       return;
   }
 
-  llvm::Function *CalleeF = getFunction(className + "_" + node.getName());
+  // inherited one lives on a base class, a base object
+  // is a prefix of this one, so `this` is the same pointer
+  std::string calleeName = className + "_" + node.getName();
+  auto classDecl = layouts->classOf(className);
+  if (auto method = classDecl ? methodDeclOf(*classDecl, calleeName) : nullptr;
+      method && method->isInherited && method->original)
+    calleeName = method->original->getName();
+
+  llvm::Function *CalleeF = getFunction(calleeName);
 
   if (node.getName() == "Size") {
-    llvm::Type* type = alloc->getAllocatedType();
-    llvm::Value* nullValue = llvm::ConstantPointerNull::get(llvm::PointerType::get(type, 0));
-    llvm::Value* offset = builder->CreateGEP(type, nullValue, llvm::ConstantInt::get(*context, llvm::APInt(16, 1)));
-    lastValue = builder->CreatePtrToInt(offset, llvm::Type::getInt64Ty(*context), "typeSize");
+    lastValue = sizeOf(storedType(alloc, decl.get()));
     return;
   }
 
   if (!CalleeF)
     return;
 
+  // overriden below a static type, see ClassHierarchy
+  llvm::Value *callee = CalleeF;
+  if (node.vtableIndex >= 0 && classDecl)
+    callee = loadVirtual(self, *classDecl, node.vtableIndex);
+
   if (CalleeF->getReturnType()->isVoidTy()) {
-    lastValue = builder->CreateCall(CalleeF, ArgsV);
+    lastValue = builder->CreateCall(CalleeF->getFunctionType(), callee, ArgsV);
   }
   else {
-    lastValue = builder->CreateCall(CalleeF, ArgsV, "calltmp");
+    lastValue = builder->CreateCall(CalleeF->getFunctionType(), callee, ArgsV, "calltmp");
+  }
+}
+
+// ======== STRUCTURE OF ARRAYS =========
+ClassDecl *CodeGenVisitor::soaClassOf(const Entity *decl) {
+  if (!decl || decl->getKind() != E_Variable_Decl)
+    return nullptr;
+  auto var = static_cast<const VarDecl *>(decl);
+  if (!var->attribute("soa") || !var->type || var->type->kind != TYPE_ARRAY)
+    return nullptr;
+  auto elType = std::static_pointer_cast<TypeArray>(var->type)->el_type;
+  return elType ? layouts->classOf(elType->name) : nullptr;
+}
+
+llvm::Value *CodeGenVisitor::soaElement(llvm::Value *soa, llvm::Type *soaType,
+                                        unsigned member, llvm::Value *index) {
+  auto i32 = llvm::Type::getInt32Ty(*context);
+  return builder->CreateInBoundsGEP(
+    soaType, soa,
+    {llvm::ConstantInt::get(i32, 0), llvm::ConstantInt::get(i32, member), index});
+}
+
+llvm::Value *CodeGenVisitor::gatherElement(const ClassDecl &classDecl,
+                                           llvm::Value *soa, llvm::Type *soaType,
+                                           llvm::Value *index) {
+  auto element = localAlloca(classDecl.structType, "element");
+  for (unsigned member = 0; member < classDecl.structType->getNumElements(); member++) {
+    if (ClassLayout::isPadding(classDecl, member))
+      continue;
+    auto type = classDecl.structType->getElementType(member);
+    auto value = builder->CreateLoad(type, soaElement(soa, soaType, member, index));
+    builder->CreateStore(value,
+      builder->CreateStructGEP(classDecl.structType, element, member));
+  }
+  return element;
+}
+
+void CodeGenVisitor::scatterElement(const ClassDecl &classDecl,
+                                    llvm::Value *soa, llvm::Type *soaType,
+                                    llvm::Value *index, llvm::Value *object) {
+  for (unsigned member = 0; member < classDecl.structType->getNumElements(); member++) {
+    if (ClassLayout::isPadding(classDecl, member))
+      continue;
+    auto type = classDecl.structType->getElementType(member);
+    auto value = builder->CreateLoad(type,
+      builder->CreateStructGEP(classDecl.structType, object, member));
+    builder->CreateStore(value, soaElement(soa, soaType, member, index));
+  }
+}
+
+// ======== STRING =========
+
+llvm::FunctionCallee CodeGenVisitor::stringRuntime(llvm::StringRef name) {
+  auto ptr = llvm::PointerType::get(*context, 0);
+  auto i64 = builder->getInt64Ty();
+  llvm::FunctionType *type = nullptr;
+  if (name == "obw_string_new")
+    type = llvm::FunctionType::get(ptr, {ptr, i64}, false);
+  else if (name == "obw_string_append" || name == "obw_string_concat_bytes")
+    type = llvm::FunctionType::get(ptr, {ptr, ptr, i64}, false);
+  else if (name == "obw_string_push")
+    type = llvm::FunctionType::get(ptr, {ptr, builder->getInt8Ty()}, false);
+  else if (name == "obw_string_free")
+    type = llvm::FunctionType::get(builder->getVoidTy(), {ptr}, false);
+  else
+    type = llvm::FunctionType::get(builder->getInt1Ty(), {ptr, ptr, i64}, false);
+
+  auto callee = module->getOrInsertFunction(name, type);
+  if (auto function = llvm::dyn_cast<llvm::Function>(callee.getCallee())) {
+    function->setDoesNotThrow();
+    // C bool
+    if (type->getReturnType()->isIntegerTy(1))
+      function->addRetAttr(llvm::Attribute::ZExt);
+  }
+  return callee;
+}
+
+void CodeGenVisitor::keepString(llvm::Value *string) {
+  auto ptr = llvm::PointerType::get(*context, 0);
+  auto function = builder->GetInsertBlock()->getParent();
+  auto slot = createEntryBlockAlloca(function, ptr, "string.slot");
+  // null until a call site runs, a return before it frees nothing
+  llvm::IRBuilder<> entry(slot->getParent(), std::next(slot->getIterator()));
+  entry.CreateStore(llvm::ConstantPointerNull::get(ptr), slot);
+
+  // a String of a previous execution is dead by now,
+  // a loop keeps none in a local (see EscapeAnalysis)
+  builder->CreateCall(stringRuntime("obw_string_free"),
+                      {builder->CreateLoad(ptr, slot)});
+  builder->CreateStore(string, slot);
+  stringSlots.push_back(slot);
+}
+
+void CodeGenVisitor::freeStrings(llvm::Function &function) {
+  if (!stringSlots.empty()) {
+    auto ptr = llvm::PointerType::get(*context, 0);
+    auto free = stringRuntime("obw_string_free");
+    for (auto &block : function) {
+      auto ret = llvm::dyn_cast_or_null<llvm::ReturnInst>(block.getTerminator());
+      if (!ret)
+        continue;
+      // a value of a ret is computed already
+      llvm::IRBuilder<> exit(ret);
+      for (auto slot : stringSlots)
+        exit.CreateCall(free, {exit.CreateLoad(ptr, slot)});
+    }
   }
+  stringSlots.clear();
+}
+
+llvm::StructType *CodeGenVisitor::stringHead() {
+  auto i64 = builder->getInt64Ty();
+  return llvm::StructType::get(*context, {i64, i64, llvm::PointerType::get(*context, 0)});
 }
 
-llvm::Value* CodeGenVisitor::getSizeOfValue(llvm::Value* value) {
-  llvm::Type* type = value->getType();
-  llvm::Value* nullValue =
-    llvm::ConstantPointerNull::get(
-      llvm::PointerType::get(type, 0));
-  llvm::Value* offset = builder->CreateGEP(
-    type,
-    nullValue,
-    llvm::ConstantInt::get(
-      *context,
-      llvm::APInt(16, 1)));
-  return builder->CreatePtrToInt(offset, llvm::Type::getInt64Ty(*context), "typeSize");;
+std::pair<llvm::Value *, llvm::Value *>
+CodeGenVisitor::stringBytes(Expression &expr, llvm::Value *value) {
+  // a literal is a constant of a known length, see visit(StringLiteralEXP)
+  if (expr.getKind() == E_String_Literal)
+    return {value, builder->getInt64(
+                       static_cast<StringLiteralEXP &>(expr).value.size())};
+
+  auto type = typeOf(expr);
+  if (type && type->kind == TYPE_STRING) {
+    auto head = stringHead();
+    auto length = builder->CreateLoad(builder->getInt64Ty(),
+                                      builder->CreateStructGEP(head, value, 0));
+    auto data = builder->CreateLoad(llvm::PointerType::get(*context, 0),
+                                    builder->CreateStructGEP(head, value, 2));
+    return {data, length};
+  }
+
+  return {value, builder->CreateCall(module->getFunction("strlen"), {value})};
+}
+
+// ======== VIRTUAL DISPATCH =========
+const MethodDecl *CodeGenVisitor::methodDeclOf(const ClassDecl &classDecl,
+                                              const std::string &name) {
+  for (auto &method : classDecl.methods) {
+    if (method->getName() == name && method->getKind() == E_Method_Decl)
+      return static_cast<const MethodDecl *>(method.get());
+  }
+  return nullptr;
+}
+
+llvm::GlobalVariable *CodeGenVisitor::vtableOf(const ClassDecl &classDecl) {
+  auto tableType = llvm::ArrayType::get(llvm::PointerType::get(*context, 0),
+                                        classDecl.vtable.size());
+  // declared here, defined by a module of a class
+  return llvm::cast<llvm::GlobalVariable>(
+    module->getOrInsertGlobal(classDecl.getName() + "_vtable", tableType));
+}
+
+// at one index down a hierarchy, see ClassLayout
+llvm::Value *CodeGenVisitor::vptrOf(llvm::Value *object, const ClassDecl &classDecl) {
+  return builder->CreateStructGEP(classDecl.structType, object,
+                                  classDecl.vptrIndex, "vptr");
+}
+
+void CodeGenVisitor::initVtable(llvm::Value *object, const ClassDecl &classDecl) {
+  if (classDecl.vtable.empty())
+    return;
+  builder->CreateStore(vtableOf(classDecl), vptrOf(object, classDecl));
+}
+
+void CodeGenVisitor::restoreVtable(llvm::Value *object, llvm::Type *type) {
+  auto structType = llvm::dyn_cast<llvm::StructType>(type);
+  if (!structType || !structType->hasName())
+    return;
+  auto classDecl = layouts->classOf(structType->getName().str());
+  if (classDecl && classDecl->vptrIndex >= 0)
+    initVtable(object, *classDecl);
+}
+
+llvm::Value *CodeGenVisitor::loadVirtual(llvm::Value *object,
+                                         const ClassDecl &classDecl, int slot) {
+  auto ptrType = llvm::PointerType::get(*context, 0);
+  auto vtable = builder->CreateLoad(ptrType, vptrOf(object, classDecl), "vtable");
+  auto entry = builder->CreateConstGEP1_32(ptrType, vtable, slot);
+  return builder->CreateLoad(ptrType, entry, "virtual");
+}
+
+llvm::ConstantInt *CodeGenVisitor::sizeOf(llvm::Type *type) {
+  return builder->getInt64(module->getDataLayout().getTypeAllocSize(type));
+}
+
+llvm::Type *CodeGenVisitor::assignedType(AssignmentSTMT &node,
+                                         llvm::Value *target) {
+  switch (node.assKind) {
+  case VAR_ASS: {
+    auto decl = currentScope->getSymbol(node.variable->getName())->decl;
+    return storedType(target, decl.get());
+  }
+  case FIELD_ASS:
+    if (auto classDecl = ownerOf(*node.field))
+      if (auto field = classDecl->fieldLayout(node.field->getName()))
+        return field->type;
+    return typeOf(*node.field)->toLLVMType(*context);
+  case EL_ASS:
+    // a GEP with zero indices is folded to its base
+    if (auto gep = llvm::dyn_cast<llvm::GEPOperator>(target))
+      return gep->getResultElementType();
+    return elementTypeOf(*node.element)->toLLVMType(*context);
+  }
+  return nullptr;
+}
+
+void CodeGenVisitor::emitCopy(llvm::Value *dst, llvm::Value *src,
+                              llvm::Type *type) {
+  const auto &dataLayout = module->getDataLayout();
+  auto dstAlign = dst->getPointerAlignment(dataLayout);
+  auto srcAlign = src->getPointerAlignment(dataLayout);
+  uint64_t size = dataLayout.getTypeAllocSize(type);
+  if (size <= maxLoadStoreCopy) {
+    auto value = builder->CreateAlignedLoad(type, src, srcAlign);
+    builder->CreateAlignedStore(value, dst, dstAlign);
+  } else {
+    builder->CreateMemCpy(dst, dstAlign, src, srcAlign, size);
+  }
+  restoreVtable(dst, type);
+}
+
+std::shared_ptr<Type> CodeGenVisitor::elementTypeOf(ElementRefEXP &node) {
+  auto arrType = currentScope->lookup<VarDecl>(node.arr->getName())->type;
+  switch (arrType->kind) {
+    case TYPE_ARRAY:
+      return std::static_pointer_cast<TypeArray>(arrType)->el_type;
+    case TYPE_LIST:
+      return std::static_pointer_cast<TypeList>(arrType)->el_type;
+    case TYPE_ACCESS:
+      return std::static_pointer_cast<TypeAccess>(arrType)->to;
+    default:
+      return arrType;
+  }
+}
+
+ClassDecl *CodeGenVisitor::ownerOf(FieldRefEXP &node) {
+  std::shared_ptr<Type> type;
+  if (node.obj)
+    type = typeOf(*node.obj);
+  else if (node.el)
+    type = elementTypeOf(*node.el);
+  if (!type)
+    return nullptr;
+
+  if (type->kind == TYPE_ACCESS)
+    type = std::static_pointer_cast<TypeAccess>(type)->to;
+  return layouts->classOf(type->name);
+}
+
+llvm::Value *CodeGenVisitor::indexOf(ElementRefEXP &node) {
+  node.index->accept(*this);
+  // load index value -> index is an Expresssion
+  auto indexVal = unwrapPointerReference(node.index.get(), lastValue);
+
+  // convert index to i64 if it's not already
+  if (indexVal->getType() != llvm::Type::getInt64Ty(*context)) {
+    indexVal = builder->CreateSExt(indexVal, llvm::Type::getInt64Ty(*context));
+  }
+  return indexVal;
 }
 
 llvm::Value*
@@ -1362,27 +1895,13 @@ CodeGenVisitor::unwrapPointerReference(Expression *node, llvm::Value *val) {
 
   // @FIXME
   if (node->getKind() != E_Function_Call && node->getKind() != E_Element_Reference)
-    if (node->resolveType(typeTable->types[moduleName], currentScope)->kind == TYPE_ACCESS) return val;
+    if (typeOf(*node)->kind == TYPE_ACCESS) return val;
 
   switch (node->getKind()) {
     case E_Element_Reference: {
       auto elementRef = static_cast<ElementRefEXP*>(node);
-      auto arrType = currentScope->lookup<VarDecl>(elementRef->arr->getName())->type;
-
-      std::shared_ptr<Type> el_type;
-      switch (arrType->kind) {
-        case TYPE_ARRAY: case TYPE_LIST: {
-          el_type = std::static_pointer_cast<TypeArray>(arrType)->el_type;
-          break;
-        }
-        case TYPE_ACCESS: {
-          el_type = std::static_pointer_cast<TypeAccess>(arrType)->to;
-          break;
-        }
-      }
-
       val = builder->CreateLoad(
-        el_type->toLLVMType(*context),
+        elementTypeOf(*elementRef)->toLLVMType(*context),
         val
       );
     } break;
@@ -1390,63 +1909,21 @@ CodeGenVisitor::unwrapPointerReference(Expression *node, llvm::Value *val) {
 
     } break;
     case E_Field_Reference: {
-      std::shared_ptr<Type> type = nullptr;
-      llvm::AllocaInst* alloca = nullptr;
-
       auto fieldRef = static_cast<FieldRefEXP*>(node);
-      if (fieldRef->obj) {
-        auto [varDecl, temp_alloca, isInited] = *currentScope->getSymbol(fieldRef->obj->getName());
-        alloca = temp_alloca;
-        type = varDecl->resolveType(typeTable->types[moduleName], currentScope);
-      }
-      else if (fieldRef->el) {
-        auto var_ref = fieldRef->el->arr;
-        auto obj_decl = std::static_pointer_cast<VarDecl>(
-          currentScope->lookup(var_ref->getName()));
-
-        // fieldRef->el->accept(*this);
-        // alloca = lastValue;
-        type = std::static_pointer_cast<TypeArray>(obj_decl->type)->el_type;
-      }
-
-      // auto [varDecl, alloca, isInited] = *currentScope->getSymbol<VarDecl>(fieldRef->obj->getName());
-
-      // type = varDecl->resolveType(typeTable->types[moduleName], currentScope);
-      if (type->kind == TYPE_ACCESS) {
-        type = std::static_pointer_cast<TypeAccess>(type)->to;
-      }
-
-      auto classTypeLLVM = type->toLLVMType(*context);
-      size_t field_index = fieldRef->index;
-
-      // if inherited
-      auto base = std::dynamic_pointer_cast<TypeClass>(type)->base_class;
-      if (base) {
-        auto baseDecl = currentScope->lookup<ClassDecl>(base->name);
-
-        if (std::ranges::any_of(
-          baseDecl->fields,
-          [&](auto f) { return f->getName() == fieldRef->getName(); })
-          ) {
-          // its an inherited
-          // @TODO sem check overriding existing fields
-          classTypeLLVM = base->toLLVMType(*context);
-        }
-
-      }
+      auto classDecl = ownerOf(*fieldRef);
+      auto field = classDecl ? classDecl->fieldLayout(fieldRef->getName()) : nullptr;
 
       val = builder->CreateLoad(
-        classTypeLLVM->getStructElementType(field_index),
+        field ? field->type : typeOf(*fieldRef)->toLLVMType(*context),
         val
       );
     } break;
     case E_Constructor_Call: {
       auto obj_ref = static_cast<ConstructorCallEXP*>(node);
-      auto className = obj_ref->left->getName();
-
-      auto classTypeLLVM = 
-        currentScope->lookup(className)->resolveType(typeTable->types[moduleName], currentScope)->toLLVMType(*context);
-      
+      // a String is a pointer itself
+      if (typeOf(*obj_ref)->kind == TYPE_STRING)
+        break;
+      auto classTypeLLVM = typeOf(*obj_ref)->toLLVMType(*context);
 
       val = builder->CreateLoad(
         classTypeLLVM,
@@ -1458,11 +1935,8 @@ CodeGenVisitor::unwrapPointerReference(Expression *node, llvm::Value *val) {
   return val;
 }
 
-// UNUSED
-
-// void CodeGenVisitor::visit(Block& block) {
-//   // ???
-// }
+// an else branch
+void CodeGenVisitor::visit(Block &block) { emitBlock(block); }
 
 void CodeGenVisitor::visit(BoolLiteralEXP &node) {
   lastValue = llvm::ConstantInt::get(llvm::Type::getInt1Ty(*context), node.getValue());
@@ -1474,9 +1948,10 @@ void CodeGenVisitor::visit(ClassNameEXP &node) {
 }
 
 void CodeGenVisitor::visit(CompoundEXP &node) {
-  for (auto &expr : node.parts) {
-    expr->accept(*this);
-  }
+  // a part is left of the next one (see Parser::parseMemberAccess),
+  // the last is a whole chain, s.Append(a).Append(b) appends once each
+  if (!node.parts.empty())
+    node.parts.back()->accept(*this);
 }
 
 void CodeGenVisitor::visit(ThisEXP &node) {
@@ -1488,16 +1963,229 @@ void CodeGenVisitor::visit(ParameterDecl &node) {
   lastValue = nullptr;
 }
 
-void CodeGenVisitor::visit(CaseSTMT &node) {
+// arms of a switch emit them, see emitSwitch
+void CodeGenVisitor::visit(CaseSTMT &node) {}
 
+void CodeGenVisitor::visit(SwitchSTMT &node) {
+  std::vector<SwitchArm> arms;
+  for (const auto &caseStmt : node.cases) {
+    if (!caseStmt)
+      continue;
+    arms.push_back({caseStmt->isDefault ? nullptr
+                                        : caseStmt->condition_literal.get(),
+                    caseStmt->body.get(), currentScope});
+  }
+  emitSwitch(*node.condition, arms);
 }
 
-void CodeGenVisitor::visit(SwitchSTMT &node) {
+bool CodeGenVisitor::emitSwitch(Expression &subject,
+                                const std::vector<SwitchArm> &arms) {
+  // a subject is an integer (see SemanticAnalyzer), checked
+  // by its type, so nothing is emitted for another one
+  auto subjectType = typeOf(subject);
+  auto type = subjectType ? llvm::dyn_cast_or_null<llvm::IntegerType>(
+                                subjectType->toLLVMType(*context))
+                          : nullptr;
+  if (!type)
+    return false;
+  subject.accept(*this);
+  auto value = lastValue;
+
+  auto enclosingScope = currentScope;
+  auto function = builder->GetInsertBlock()->getParent();
+  auto endBB = llvm::BasicBlock::Create(*context, "switchend");
+
+  // labels are constants (see SemanticAnalyzer), so they
+  // take no code and go before a switch itself
+  std::vector<std::pair<llvm::ConstantInt *, llvm::BasicBlock *>> cases;
+  std::vector<llvm::BasicBlock *> blocks;
+  llvm::BasicBlock *defaultBB = nullptr;
+  std::set<int64_t> seen;
+  for (const auto &arm : arms) {
+    auto armBB = llvm::BasicBlock::Create(*context, arm.label ? "case" : "default");
+    blocks.push_back(armBB);
+    if (!arm.label) {
+      defaultBB = armBB;
+      continue;
+    }
+    arm.label->accept(*this);
+    auto label = llvm::cast<llvm::ConstantInt>(lastValue);
+    // in an if chain the first compare wins
+    if (seen.insert(label->getSExtValue()).second) {
+      cases.emplace_back(
+          llvm::ConstantInt::get(type, label->getSExtValue(), true), armBB);
+    }
+  }
+
+  auto switchInst =
+      builder->CreateSwitch(value, defaultBB ? defaultBB : endBB, cases.size());
+  for (const auto &[label, armBB] : cases)
+    switchInst->addCase(label, armBB);
+
+  for (size_t i = 0; i < arms.size(); i++) {
+    function->insert(function->end(), blocks[i]);
+    builder->SetInsertPoint(blocks[i]);
+    currentScope = arms[i].scope;
+    emitBlock(*arms[i].body);
+    // no fallthrough, every arm leaves a switch
+    if (!builder->GetInsertBlock()->getTerminator())
+      builder->CreateBr(endBB);
+  }
+  currentScope = enclosingScope;
 
+  function->insert(function->end(), endBB);
+  builder->SetInsertPoint(endBB);
+  return true;
+}
+
+std::vector<CodeGenVisitor::SwitchArm>
+CodeGenVisitor::switchArmsOf(IfSTMT &node) {
+  // x.Equal(c) of one variable x and a constant c
+  std::string subject;
+  auto compared = [&](const Expression &condition) -> Expression * {
+    if (condition.getKind() != E_Method_Call)
+      return nullptr;
+    auto &call = static_cast<const MethodCallEXP &>(condition);
+    if (lookupBuiltinMethod(call.getName()) != BM_EQUAL || !call.left ||
+        call.left->getKind() != E_Var_Reference || call.arguments.size() != 1)
+      return nullptr;
+    auto label = call.arguments[0].get();
+    if (label->getKind() != E_Integer_Literal &&
+        label->getKind() != E_Enum_Reference)
+      return nullptr;
+    if (subject.empty())
+      subject = call.left->getName();
+    return call.left->getName() == subject ? label : nullptr;
+  };
+
+  std::vector<SwitchArm> arms;
+  for (auto ifStmt = &node;;) {
+    auto label = compared(*ifStmt->condition);
+    if (!label)
+      return {};
+    arms.push_back({label, ifStmt->ifTrue.get(), ifStmt->scope});
+
+    auto rest = ifStmt->ifFalse.get();
+    if (!rest)
+      break;
+    if (rest->getKind() == E_If_Statement) {
+      ifStmt = static_cast<IfSTMT *>(rest);
+      continue;
+    }
+    if (rest->getKind() != E_Block)
+      return {};
+    // else of the last if, in its scope
+    arms.push_back({nullptr, static_cast<Block *>(rest), ifStmt->scope});
+    break;
+  }
+
+  auto compares = std::ranges::count_if(
+      arms, [](const SwitchArm &arm) { return arm.label != nullptr; });
+  if (static_cast<size_t>(compares) < minSwitchChain)
+    return {};
+  // Integer or an enum item, not a Real or a Boolean
+  auto type = typeOf(*static_cast<MethodCallEXP &>(*node.condition).left);
+  if (!type || (type->kind != TYPE_INT && type->kind != TYPE_I64))
+    return {};
+  return arms;
 }
 
 void CodeGenVisitor::visit(WhileSTMT &node) {
-  
+  auto enclosingScope = currentScope;
+  currentScope = node.scope;
+  emitLoop(*node.condition, node.body.get(), nullptr, node.hints);
+  currentScope = enclosingScope;
+}
+
+void CodeGenVisitor::emitLoop(Expression &condition, Block *body,
+                              Statement *step, const Attributes &hints) {
+  auto function = builder->GetInsertBlock()->getParent();
+  auto headerBB = llvm::BasicBlock::Create(*context, "loop.header", function);
+  auto bodyBB = llvm::BasicBlock::Create(*context, "loop.body");
+  auto latchBB = llvm::BasicBlock::Create(*context, "loop.latch");
+  auto exitBB = llvm::BasicBlock::Create(*context, "loop.exit");
+
+  // a block a loop is entered from is its preheader
+  builder->CreateBr(headerBB);
+
+  // a condition is tested before every iteration, the first one too
+  builder->SetInsertPoint(headerBB);
+  condition.accept(*this);
+  builder->CreateCondBr(lastValue, bodyBB, exitBB);
+
+  function->insert(function->end(), bodyBB);
+  builder->SetInsertPoint(bodyBB);
+  if (body)
+    emitBlock(*body);
+  // a return leaves a loop from a body
+  if (!builder->GetInsertBlock()->getTerminator())
+    builder->CreateBr(latchBB);
+
+  // the only back edge, it carries an identity of a loop
+  function->insert(function->end(), latchBB);
+  builder->SetInsertPoint(latchBB);
+  if (step)
+    step->accept(*this);
+  auto backEdge = builder->CreateBr(headerBB);
+  backEdge->setMetadata(llvm::LLVMContext::MD_loop,
+                        loopMetadata(loopHints(hints)));
+
+  function->insert(function->end(), exitBB);
+  builder->SetInsertPoint(exitBB);
+}
+
+std::vector<llvm::Metadata *>
+CodeGenVisitor::loopHints(const Attributes &hints) {
+  if (!hints.empty() && options.optLevel == 0 && !warnedHints) {
+    llvm::errs() << "warning: " << moduleName
+                 << ": loop hints have no effect without -O\n";
+    warnedHints = true;
+  }
+
+  auto i1 = llvm::Type::getInt1Ty(*context);
+  auto i32 = llvm::Type::getInt32Ty(*context);
+  std::vector<llvm::Metadata *> properties;
+  auto property = [&](const char *name, llvm::Type *type, int64_t value) {
+    properties.push_back(llvm::MDNode::get(
+        *context, {llvm::MDString::get(*context, name),
+                   llvm::ConstantAsMetadata::get(
+                       llvm::ConstantInt::get(type, value))}));
+  };
+  auto flag = [&](const char *name) {
+    properties.push_back(
+        llvm::MDNode::get(*context, llvm::MDString::get(*context, name)));
+  };
+
+  // checked by SemanticAnalyzer::checkLoopHints
+  for (const auto &hint : hints) {
+    if (hint.name == "unroll" && hint.value) {
+      property("llvm.loop.unroll.count", i32, *hint.value);
+    } else if (hint.name == "unroll") {
+      flag("llvm.loop.unroll.enable");
+    } else if (hint.name == "nounroll") {
+      flag("llvm.loop.unroll.disable");
+    } else if (hint.name == "vectorize") {
+      property("llvm.loop.vectorize.enable", i1, 1);
+      if (hint.value)
+        property("llvm.loop.vectorize.width", i32, *hint.value);
+    } else if (hint.name == "novectorize") {
+      // width 1 still lets a loop be interleaved
+      property("llvm.loop.vectorize.width", i32, 1);
+    } else if (hint.name == "interleave" && hint.value) {
+      property("llvm.loop.interleave.count", i32, *hint.value);
+    }
+  }
+  return properties;
+}
+
+llvm::MDNode *
+CodeGenVisitor::loopMetadata(llvm::ArrayRef<llvm::Metadata *> properties) {
+  // distinct, its first operand is itself
+  llvm::SmallVector<llvm::Metadata *, 4> operands = {nullptr};
+  operands.append(properties.begin(), properties.end());
+  auto loopID = llvm::MDNode::getDistinct(*context, operands);
+  loopID->replaceOperandWith(0, loopID);
+  return loopID;
 }
 
 // ======== GENERICS =========
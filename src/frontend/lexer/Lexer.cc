@@ -192,6 +192,19 @@ Lexer::Lexer(std::shared_ptr<SourceBuffer> buffer) {
 #endif
 }
 
+char Lexer::escaped(char c) {
+  switch (c) {
+  case 'n':
+    return '\n';
+  case 't':
+    return '\t';
+  case 'r':
+    return '\r';
+  default: // \\ and \" too
+    return c;
+  }
+}
+
 bool Lexer::isSpecial(char c) {
   return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '.' ||
          c == '"' || c == '(' || c == ')' || c == ',' || c == '[' || c == ']' ||
@@ -217,9 +230,9 @@ std::unique_ptr<Token> Lexer::next() {
       return std::make_unique<Token>(TOKEN_EOF, curr_line, curr_column);
     }
 
-    // Skip comments
+    // Skip comments, a string may have slashes
     // @TODO test, this is SUS
-    if (c == '/') {
+    if (c == '/' && curr_state != STATE_READ_STRING) {
       if (buffer[1] != '/') break;
 
       while (c != '\n') {
@@ -304,7 +317,10 @@ std::unique_ptr<Token> Lexer::next() {
 
         return std::make_unique<Token>(TOKEN_LESS, curr_line, curr_column);
       } else if (c == '"') {
+        // quotes are not a part of a value
         curr_state = STATE_READ_STRING;
+        advance();
+        continue;
       } else if (c == '(') {
         curr_state = STATE_START;
         advance();
@@ -505,13 +521,19 @@ std::unique_ptr<Token> Lexer::next() {
     case STATE_READ_STRING: {
       if (c == '"') {
         curr_state = STATE_START;
-        token += c;
         advance();
         return std::make_unique<Token>(TOKEN_STRING, token, curr_line,
                                        curr_column /* - token.length() + 1 */);
       }
-      curr_state = STATE_READ_STRING;
-    } break;
+      // escapes are replaced once here, a value is what goes to a binary
+      if (c == '\\' && buffer[1] != '\0') {
+        advance();
+        c = escaped(peek());
+      }
+      token += c;
+      advance();
+      continue;
+    }
     case STATE_READ_ARROW: {
       if (c == '>') {
         curr_state = STATE_START;
@@ -529,10 +551,6 @@ std::unique_ptr<Token> Lexer::next() {
     if (!std::isspace(c) && c != '\n' && c != '\r')
       token += c;
 
-    // @TODO move up
-    if (curr_state == STATE_READ_STRING && std::isspace(c))
-      token += c;
-
     // If no token has been returned move to next char, i.e. eat input
     advance();
 #ifdef DEBUG
@@ -41,6 +41,8 @@ bool ParameterDecl::validate() {
 
 std::shared_ptr<Type> MethodDecl::resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) {
   (void)typeTable;
+  // declared by name only, signature is not known yet
+  if (!signature) return nullptr;
   return signature->return_type;
 }
 
@@ -51,6 +53,8 @@ bool MethodDecl::validate() {
 
 std::shared_ptr<Type> FuncDecl::resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) {
   (void)typeTable;
+  // builtin functions are declared without a signature
+  if (!signature) return nullptr;
   return signature->return_type;
 }
 
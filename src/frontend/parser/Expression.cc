@@ -1,5 +1,6 @@
 #include "frontend/parser/Expression.h"
 
+#include "frontend/types/Builtins.h"
 #include "frontend/types/Decl.h"
 
 Expression::~Expression() {}
@@ -17,21 +18,23 @@ std::shared_ptr<Type> RealLiteralEXP::resolveType(const TypeTable &typeTable, co
 std::shared_ptr<Type> StringLiteralEXP::resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) {
   // auto type = std::make_unique<TypeString>(sizeof(value.c_str()));
   // return type;
-  return std::make_shared<TypeAccess>(typeTable.getType("byte"));
+  return typeTable.interner->getAccessType(typeTable.getType("byte"));
 }
 
 std::shared_ptr<Type> BoolLiteralEXP::resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) {
   // auto type = std::make_unique<TypeBuiltin>(TYPE_BOOL, "Bool", 1);
   // return type;
-  return typeTable.getType("Bool");
+  return typeTable.getType("Boolean");
 }
 
 std::shared_ptr<Type> ArrayLiteralExpr::resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) {
-  // name of ArrayType = Array[<type_of_el_1>_<size>]
+  // array types are canonical by (element type, size)
   // @TODO multi diemnsion arrays and TPYE_KIND
-  auto elType = typeTable.getType(el_type);
-  auto arrayTypeName = "Array[" + elType->name + "_" + std::to_string(elements.size()) + "]";
-  return typeTable.getType(arrayTypeName);
+  auto elType = el_type == TYPE_UNKNOWN
+    ? elements[0]->resolvedType(typeTable, currentScope)
+    : typeTable.getType(el_type);
+  if (!elType) return nullptr;
+  return typeTable.interner->getArrayType(elType, elements.size());
 }
 
 bool ArrayLiteralExpr::validate() {
@@ -39,32 +42,55 @@ bool ArrayLiteralExpr::validate() {
   return true;
 }
 
+std::shared_ptr<Type> ElementRefEXP::resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) {
+  if (!arr) return nullptr;
+  auto arrType = arr->resolvedType(typeTable, currentScope);
+  if (!arrType) return nullptr;
+
+  switch (arrType->kind) {
+    case TYPE_ARRAY:
+      return std::static_pointer_cast<TypeArray>(arrType)->el_type;
+    case TYPE_LIST:
+      return std::static_pointer_cast<TypeList>(arrType)->el_type;
+    case TYPE_ACCESS:
+      return std::static_pointer_cast<TypeAccess>(arrType)->to;
+    default:
+      return nullptr;
+  }
+}
+
 std::shared_ptr<Type> FieldRefEXP::resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) {
   std::string objTypeName;
 
   if (el) {
-    auto arrType = el->arr->resolveType(typeTable, currentScope);
-    auto elType = std::dynamic_pointer_cast<TypeArray>(arrType)->el_type;
+    auto elType = el->resolvedType(typeTable, currentScope);
+    if (!elType) return nullptr;
     objTypeName = elType->name;
   }
-  else {
-    auto objType = obj->resolveType(typeTable, currentScope);
-    objTypeName = objType->name;
+  else if (obj) {
+    auto objType = obj->resolvedType(typeTable, currentScope);
+    if (!objType) return nullptr;
+    objTypeName = objType->kind == TYPE_ACCESS
+      ? std::static_pointer_cast<TypeAccess>(objType)->to->name
+      : objType->name;
 
     if (obj->getKind() == E_This) {
       objTypeName = currentScope->prevScope()->getName();
     }
   }
+  else return nullptr;
+
+  auto classInfo = currentScope->getSymbol(objTypeName);
+  if (!classInfo) return nullptr;
+  auto classDecl = std::dynamic_pointer_cast<ClassDecl>(classInfo->decl);
+  if (!classDecl) return nullptr;
 
-  auto [decl, alloca, isInited] = *currentScope->getSymbol(objTypeName);
-  auto classDecl = std::dynamic_pointer_cast<ClassDecl>(decl);
   auto fieldDecl = std::find_if(
     classDecl->fields.begin(),
     classDecl->fields.end(),
     [this](const std::shared_ptr<FieldDecl> &fd) { return fd->getName() == this->name; });
   if (fieldDecl == classDecl->fields.end()) return nullptr;
   return (*fieldDecl)->type;
-  return nullptr;
 }
 
 bool FieldRefEXP::validate() {
@@ -73,8 +99,9 @@ bool FieldRefEXP::validate() {
 }
 
 std::shared_ptr<Type> VarRefEXP::resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) {
-  auto [decl, alloca, isInited] = *currentScope->getSymbol(name);
-  return decl->resolveType(typeTable, currentScope);
+  auto symbol = currentScope->getSymbol(name);
+  if (!symbol || !symbol->decl) return nullptr;
+  return symbol->decl->resolveType(typeTable, currentScope);
 }
 
 bool VarRefEXP::validate() {
@@ -83,27 +110,31 @@ bool VarRefEXP::validate() {
 }
 
 std::shared_ptr<Type> MethodCallEXP::resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) {
-  // auto varRef = std::static_pointer_cast<VarRefEXP>(left);
+  if (!left) return nullptr;
 
-  // nested
-  auto leftOp = left;
-  while (leftOp->getKind() == E_Method_Call) {
-    leftOp = std::static_pointer_cast<MethodCallEXP>(leftOp)->left;
-  }
+  // in a chain every call is resolved against
+  // the type returned by the previous one
+  auto leftType = left->resolvedType(typeTable, currentScope);
+  if (!leftType) return nullptr;
+  if (leftType->kind == TYPE_ACCESS)
+    leftType = std::static_pointer_cast<TypeAccess>(leftType)->to;
 
-  auto [decl, _, __] = *currentScope->getSymbol(leftOp->getName());
-  auto typeNameOfLeftOperand = decl->resolveType(typeTable, currentScope)->name;
+  // builtin classes answer from the registry
+  if (auto sig = findBuiltin(leftType->kind, lookupBuiltinMethod(name)))
+    return typeTable.getType(sig->ret);
+
+  auto classInfo = currentScope->getSymbol(leftType->name);
+  if (!classInfo) return nullptr;
+  auto classDecl = std::dynamic_pointer_cast<ClassDecl>(classInfo->decl);
+  if (!classDecl) return nullptr;
 
-  auto [typeDecl, ___, ____] = *currentScope->getSymbol(typeNameOfLeftOperand);
-  auto typeDeclAsCalss = std::dynamic_pointer_cast<ClassDecl>(typeDecl);
   auto methodDecl = std::find_if(
-    typeDeclAsCalss->methods.begin(),
-    typeDeclAsCalss->methods.end(),
+    classDecl->methods.begin(),
+    classDecl->methods.end(),
     [this](const std::shared_ptr<Decl> &md) { return md->getName() == this->name; });
+  if (methodDecl == classDecl->methods.end()) return nullptr;
 
   return (*methodDecl)->resolveType(typeTable, currentScope);
-
-  return nullptr;
 }
 
 bool MethodCallEXP::validate() {
@@ -112,8 +143,8 @@ bool MethodCallEXP::validate() {
 
 std::shared_ptr<Type> FuncCallEXP::resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) {
   auto symbolInfo = currentScope->getSymbol(name);
+  if (!symbolInfo || !symbolInfo->decl) return nullptr;
   return symbolInfo->decl->resolveType(typeTable, currentScope);
-  // return nullptr;
 }
 
 bool FuncCallEXP::validate() {
@@ -132,26 +163,30 @@ bool ClassNameEXP::validate() {
 std::shared_ptr<Type> ConstructorCallEXP::resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) {
   // (void)typeTable;
   // void, becouse we pass this (self ref) as first argument and return nothing
-  return this->left->resolveType(typeTable, currentScope); // @FIXME
-  return nullptr;
+  return this->left->resolvedType(typeTable, currentScope); // @FIXME
 }
 
 bool ConstructorCallEXP::validate() { return true; }
 
 std::shared_ptr<Type> CompoundEXP::resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) {
   // last executed method -> type returned
-  return parts.back()->resolveType(typeTable, currentScope);
-  return nullptr;
+  if (parts.empty()) return nullptr;
+  return parts.back()->resolvedType(typeTable, currentScope);
 }
 
 bool CompoundEXP::validate() { return true; }
 
+std::shared_ptr<Type> EnumRefEXP::resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) {
+  if (itemName.empty()) return nullptr;
+  return typeTable.getType("Integer");
+}
+
 std::shared_ptr<Type> ThisEXP::resolveType(const TypeTable &typeTable, const std::shared_ptr<Scope<Entity>> &currentScope) {
   // current scope name will be method/constr so outer scope above is named the same
   // as a class
-  auto className = currentScope->prevScope()->getName();
-  return typeTable.getType("this" + className);
-  return nullptr;
+  auto classScope = currentScope->prevScope();
+  if (!classScope) return nullptr;
+  return typeTable.getType("this" + classScope->getName());
 }
 
 bool ThisEXP::validate() {
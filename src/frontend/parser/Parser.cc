@@ -146,7 +146,8 @@ std::shared_ptr<ModuleDecl> Parser::parseProgram() {
     token = peek();
   }
 
-  globalSymbolTable->enterScope(SCOPE_MODULE, moduleName);
+  root->scope = globalSymbolTable->enterScope(SCOPE_MODULE, moduleName);
+  globalTypeTable->initModule(moduleName);
 
   token = peek();
   while (token->kind == TOKEN_MODULE_IMP) {
@@ -174,7 +175,7 @@ std::shared_ptr<ModuleDecl> Parser::parseProgram() {
 
     sm.addIncludedModule(*buff, importedModuleName);
 
-    globalSymbolTable->copySymbolFromModulesToCurrent(
+    globalSymbolTable->importModule(
         importedModuleName, // from
         moduleName          // to
     );
@@ -185,26 +186,28 @@ std::shared_ptr<ModuleDecl> Parser::parseProgram() {
   }
 
   // import builtin modules -> Integer, ...
-  globalSymbolTable->copySymbolFromModulesToCurrent(
+  globalSymbolTable->importModule(
       "Integer", // from
-      moduleName          // to
+      moduleName // to
   );
-  globalSymbolTable->copySymbolFromModulesToCurrent(
-      "Real", // from
-      moduleName          // to
+  globalSymbolTable->importModule(
+      "Real",    // from
+      moduleName // to
   );
 
-  // import builtin types
-  for (const auto &[name, type] : globalTypeTable->builtinTypes.types) {
-    globalTypeTable->addType(moduleName, name, type);
-  }
-
   // @NOTE entering GLOBAL scope is done at creation of SymbolTable
   // which is not good, probably should happen here
 
   token = peek();
   std::shared_ptr<Entity> child;
   while (token->kind != TOKEN_EOF) {
+    // [packed] class ..., belong to a declaration after them
+    Attributes attributes;
+    if (token->kind == TOKEN_LSBRACKET) {
+      attributes = parseAttributes();
+      token = peek();
+    }
+
     // in global scope we can wait for class or function
     switch (token->kind) {
     case TOKEN_CLASS: {
@@ -224,7 +227,17 @@ std::shared_ptr<ModuleDecl> Parser::parseProgram() {
       break;
     }
 
-    root->children.push_back(child);
+    if (auto decl = std::dynamic_pointer_cast<Decl>(child);
+        decl && !attributes.empty())
+      decl->attributes = std::move(attributes);
+
+    // instances used by a declaration go before it
+    root->children.insert(root->children.end(), instances.begin(),
+                          instances.end());
+    instances.clear();
+    // a template is no declaration by itself
+    if (child)
+      root->children.push_back(child);
     token = peek();
   }
 
@@ -249,9 +262,10 @@ std::shared_ptr<FuncDecl> Parser::parseFunctionDecl() {
   token = next();
   auto func_name = std::get<std::string>(token->value);
 
-  globalSymbolTable->enterScope(SCOPE_METHOD, func_name);
+  auto func_scope = globalSymbolTable->enterScope(SCOPE_METHOD, func_name);
 
   auto func = std::make_shared<FuncDecl>(func_name, func_name == "main");
+  func->scope = func_scope;
 
 
   // get func parameters
@@ -271,7 +285,7 @@ std::shared_ptr<FuncDecl> Parser::parseFunctionDecl() {
   if (token->kind != TOKEN_COLON /*!isTypeName(token->kind)*/) {
     // no return type
     // build signature
-    auto signature = std::make_shared<TypeFunc>(args_types);
+    auto signature = globalTypeTable->getFuncType(nullptr, args_types);
     func->isVoid = true;
     func->signature = signature;
 
@@ -292,13 +306,10 @@ std::shared_ptr<FuncDecl> Parser::parseFunctionDecl() {
 
   token = next();
   token = next();
-  auto return_type =
-      globalTypeTable->getType(moduleName, std::get<std::string>(token->value));
+  auto return_type = parseReturnType(*token);
 
   // build signature
-  auto signature = func->isVoided
-                       ? std::make_shared<TypeFunc>(return_type)
-                       : std::make_shared<TypeFunc>(return_type, args_types);
+  auto signature = globalTypeTable->getFuncType(return_type, args_types);
 
   // get body of method
   auto body_block =
@@ -339,9 +350,10 @@ std::shared_ptr<MethodDecl> Parser::parseMethodDecl() {
 
   // new our scope is this method
   // lastDeclaredScopeParent.emplace(method_name);
-  globalSymbolTable->enterScope(SCOPE_METHOD, method_name);
+  auto method_scope = globalSymbolTable->enterScope(SCOPE_METHOD, method_name);
 
   auto method = std::make_shared<MethodDecl>(method_name);
+  method->scope = method_scope;
   if (is_static)
     method->isStatic = true;
 
@@ -362,7 +374,7 @@ std::shared_ptr<MethodDecl> Parser::parseMethodDecl() {
   if (token->kind != TOKEN_COLON /*!isTypeName(token->kind)*/) {
     // no return type
     // build signature
-    auto signature = std::make_shared<TypeFunc>(args_types);
+    auto signature = globalTypeTable->getFuncType(nullptr, args_types);
     method->isVoid = true;
     method->signature = signature;
 
@@ -383,13 +395,10 @@ std::shared_ptr<MethodDecl> Parser::parseMethodDecl() {
 
   token = next();
   token = next();
-  auto return_type =
-      globalTypeTable->getType(moduleName, std::get<std::string>(token->value));
+  auto return_type = parseReturnType(*token);
 
   // build signature
-  auto signature = method->isVoided
-                       ? std::make_shared<TypeFunc>(return_type)
-                       : std::make_shared<TypeFunc>(return_type, args_types);
+  auto signature = globalTypeTable->getFuncType(return_type, args_types);
 
   // get body of method
   auto body_block =
@@ -458,8 +467,10 @@ std::shared_ptr<CaseSTMT> Parser::parseCase() {
     return nullptr;
   token = next(); // eat 'case'
 
-  // case literal condition
+  // case literal condition, an integer or an enum item
   auto cond_lit = parsePrimary();
+  if (cond_lit && peek()->kind == TOKEN_DOUBLE_COLON)
+    cond_lit = parseStaticAccess(cond_lit);
   // std::shared_ptr<Expression>(
   //   dynamic_cast<Expression *>(parsePrimary().get()));
 
@@ -483,7 +494,7 @@ std::shared_ptr<IfSTMT> Parser::parseIfStatement() {
     return nullptr;
   token = next(); // eat 'if'
 
-  globalSymbolTable->enterScope(SCOPE_LOOP, "if_else");
+  auto if_scope = globalSymbolTable->enterScope(SCOPE_LOOP, "if_else");
 
   auto condition = parseExpression();
 
@@ -501,12 +512,16 @@ std::shared_ptr<IfSTMT> Parser::parseIfStatement() {
 
     globalSymbolTable->exitScope();
 
-    return std::make_shared<IfSTMT>(condition, ifTrue, ifFalse);
+    auto if_stmt = std::make_shared<IfSTMT>(condition, ifTrue, ifFalse);
+    if_stmt->scope = if_scope;
+    return if_stmt;
   }
 
   globalSymbolTable->exitScope();
 
-  return std::make_shared<IfSTMT>(condition, ifTrue);
+  auto if_stmt = std::make_shared<IfSTMT>(condition, ifTrue);
+  if_stmt->scope = if_scope;
+  return if_stmt;
 }
 
 std::shared_ptr<VarDecl> Parser::parseVarDecl() {
@@ -574,19 +589,18 @@ std::shared_ptr<VarDecl> Parser::parseVarDecl() {
     var_type = globalTypeTable->types[moduleName].getType("byte");
   } else {
     if (isPointer) {
-      auto toType = globalTypeTable->types[moduleName].getType(
-        std::get<std::string>(token->value));
-      var_type = std::make_shared<TypeAccess>(toType);
+      auto toType = parseTypeName(*token);
+      var_type = globalTypeTable->getAccessType(toType);
       type_name = var_name; // alias a type by the variable name
       globalTypeTable->addType(moduleName, type_name, var_type);
     } else {
-      var_type = globalTypeTable->types[moduleName].getType(
-          std::get<std::string>(token->value));
+      var_type = parseTypeName(*token);
     }
   }
 
-  // composite container type
-  if (peek()->kind == TOKEN_LSBRACKET) {
+  // composite container type, `[` of a next line
+  // starts attributes of a next declaration
+  if (peek()->kind == TOKEN_LSBRACKET && peek()->line == token->line) {
 
     token = next(); // eat '['
 
@@ -598,7 +612,7 @@ std::shared_ptr<VarDecl> Parser::parseVarDecl() {
 
       auto toType = globalTypeTable->types[moduleName].getType(
   el_type_name);
-      var_type = std::make_shared<TypeAccess>(toType);
+      var_type = globalTypeTable->getAccessType(toType);
       type_name = var_name; // alias a type by the variable name
       globalTypeTable->addType(moduleName, type_name, var_type);
       el_type = var_type;
@@ -606,16 +620,8 @@ std::shared_ptr<VarDecl> Parser::parseVarDecl() {
       el_type = globalTypeTable->getType(moduleName, el_type_name);
     }
 
-    // @note <TypeList> is safe, because it has only el_type field
-    auto var_type_array = std::make_shared<TypeList>(el_type);
-    var_type_array->el_type = std::move(el_type);
-
-    // size_t array_size = 0;
-
     // "," SIZE
     if (peek()->kind == TOKEN_COMMA) {
-      auto var_type_const_array = std::make_shared<TypeArray>();
-      var_type_const_array->el_type = std::move(el_type);
       token = next(); // eat ','
 
       token = peek();
@@ -623,30 +629,14 @@ std::shared_ptr<VarDecl> Parser::parseVarDecl() {
       token = next();
       size_t array_size = std::get<int>(token->value);
 
-      var_type_const_array->el_type = std::move(var_type_array->el_type);
-      var_type_const_array->size = array_size;
-
-      // Array type cant be shared, because arrays
-      // have different length
-      // taken from c++ primer
-      // `"The number of elements in an array is part of the array's type."`
-      // so we add a new array type when we encounter a decl of array
-      // indexed by a var name ?
-
-      globalTypeTable->addType(moduleName, var_name, var_type_const_array);
-
-      var_type = var_type_const_array;
+      // "The number of elements in an array is part of the array's type."
+      // so arrays are uniqued by (element type, size)
+      // and the decl aliases the canonical type by its name
+      var_type = globalTypeTable->getArrayType(el_type, array_size);
     } else {
-      // Array type cant be shared, because arrays
-      // have different length
-      // taken from c++ primer
-      // `"The number of elements in an array is part of the array's type."`
-      // so we add a new array type when we encounter a decl of array
-      // indexed by a var name ?
-      globalTypeTable->addType(moduleName, var_name, var_type_array);
-
-      var_type = var_type_array;
+      var_type = globalTypeTable->getListType(el_type);
     }
+    globalTypeTable->addType(moduleName, var_name, var_type);
 
     token = next(); // eat ']'
   }
@@ -658,6 +648,14 @@ std::shared_ptr<VarDecl> Parser::parseVarDecl() {
 
   auto var = std::make_shared<VarDecl>(var_name, var_type);
 
+  // var b : Box[Integer](42), a short constr call of an instance
+  if (peek()->kind == TOKEN_LBRACKET) {
+    var->initializer =
+        parseCallExpression(std::make_shared<ClassNameEXP>(var_type->name));
+    globalSymbolTable->getCurrentScope()->addSymbol<VarDecl>(var->getName(), var);
+    return var;
+  }
+
   // read initializer
   if (peek()->kind != TOKEN_ASSIGNMENT) {
     // this->globalSymbolTable->addToGlobalScope(
@@ -743,6 +741,14 @@ std::shared_ptr<Block> Parser::parseBlock(BlockKind blockKind, size_t fieldIndex
     std::shared_ptr<Entity> part;
 
     token = peek();
+    // [soa] var ..., [unroll(4)] while ..., belong
+    // to a declaration or a loop after them
+    Attributes attributes;
+    if (token->kind == TOKEN_LSBRACKET) {
+      attributes = parseAttributes();
+      token = peek();
+    }
+
     switch (token->kind) {
     case TOKEN_VAR_DECL: {
       if (blockKind > 0)
@@ -808,11 +814,35 @@ std::shared_ptr<Block> Parser::parseBlock(BlockKind blockKind, size_t fieldIndex
     case TOKEN_METHOD: {
       part = parseMethodDecl();
     } break;
+    case TOKEN_VIRTUAL:
+    case TOKEN_OVERRIDE: {
+      token = next(); // eat 'virtual' / 'override'
+      bool isOverride = token->kind == TOKEN_OVERRIDE;
+      // constructors are never virtual, keyword is ignored
+      if (peek()->kind == TOKEN_SELFREF) {
+        part = parseConstructorDecl();
+        break;
+      }
+      auto method = parseMethodDecl();
+      if (method) {
+        method->isVirtual = true;
+        method->isOverride = isOverride;
+      }
+      part = method;
+    } break;
     // @TODO
     default:
       return nullptr;
     }
 
+    if (auto decl = std::dynamic_pointer_cast<Decl>(part);
+        decl && !attributes.empty())
+      decl->attributes = std::move(attributes);
+    else if (auto loop = std::dynamic_pointer_cast<WhileSTMT>(part))
+      loop->hints = std::move(attributes);
+    else if (auto loop = std::dynamic_pointer_cast<ForSTMT>(part))
+      loop->hints = std::move(attributes);
+
     block_body.push_back(part);
 
     token = peek();
@@ -838,10 +868,12 @@ std::shared_ptr<ConstrDecl> Parser::parseConstructorDecl() {
 
   // ????
   // lastDeclaredScopeParent.emplace("this");
-  globalSymbolTable->enterScope(SCOPE_METHOD, className + "_Create");
+  auto constr_scope =
+      globalSymbolTable->enterScope(SCOPE_METHOD, className + "_Create");
 
   // read parameters
   auto constr = std::make_shared<ConstrDecl>(className + "_Create");
+  constr->scope = constr_scope;
 
   // read params
   parseParameters(constr);
@@ -867,8 +899,7 @@ std::shared_ptr<ConstrDecl> Parser::parseConstructorDecl() {
   //   std::get<std::string>(token->value));
 
   // build signature
-  auto signature = constr->isDefault ? std::make_shared<TypeFunc>()
-                                     : std::make_shared<TypeFunc>(args_types);
+  auto signature = globalTypeTable->getFuncType(nullptr, args_types);
 
   // read constr body
   auto body_block = parseBlock(BLOCK_IN_METHOD);
@@ -886,6 +917,7 @@ std::shared_ptr<ClassDecl> Parser::parseClassDecl() {
   std::unique_ptr<Token> token = peek();
   if (token == nullptr || token->kind != TOKEN_CLASS)
     return nullptr;
+  int start = tokenPos + 1;
   token = next(); // eat 'class'
 
   // read classname
@@ -895,13 +927,26 @@ std::shared_ptr<ClassDecl> Parser::parseClassDecl() {
   auto class_name = std::get<std::string>(token->value);
 
   // check if its generic
-  // if (peek()->kind == TOKEN_RSBRACKET) {
-  //
-  // }
+  if (peek()->kind == TOKEN_LSBRACKET) {
+    if (!instanceName) {
+      parseGenericClass(start, class_name);
+      return nullptr;
+    }
+    // replayed, parameters are bound already
+    while (next()->kind != TOKEN_RSBRACKET) {}
+  }
+  // declared ahead by instantiate
+  std::shared_ptr<TypeClass> declaredType;
+  if (instanceName) {
+    class_name = *instanceName;
+    instanceName.reset();
+    declaredType = std::dynamic_pointer_cast<TypeClass>(
+        globalTypeTable->types[moduleName].getType(class_name));
+  }
 
   // now our scope is this class
   // lastDeclaredScopeParent.emplace(class_name);
-  globalSymbolTable->enterScope(SCOPE_CLASS, class_name);
+  auto class_scope = globalSymbolTable->enterScope(SCOPE_CLASS, class_name);
 
   // see if there is extends
   std::shared_ptr<ClassDecl> base_class = nullptr;
@@ -965,24 +1010,37 @@ std::shared_ptr<ClassDecl> Parser::parseClassDecl() {
   }
 
   auto class_new_type =
-      std::make_shared<TypeClass>(class_name, fieldTypes, methodTypes);
+      declaredType ? declaredType
+                   : std::make_shared<TypeClass>(class_name, fieldTypes,
+                                                 methodTypes);
+  class_new_type->fields_types = fieldTypes;
   // add `this` as a selfref variable
-  auto selfRefType = std::make_shared<TypeAccess>(class_new_type);
+  auto selfRefType = globalTypeTable->getAccessType(class_new_type);
   globalTypeTable->addType(moduleName, "this" + class_name, selfRefType);
 
   auto thisParam = std::make_shared<ParameterDecl>("this" + class_name, selfRefType);
-  for (auto &meth : class_new_type->methods_types) {
-    meth->args.emplace(meth->args.begin(), selfRefType);
-  }
 
+  // signatures are canonical (shared between methods),
+  // so `this` is added by swapping a signature, not by mutating it
+  auto withSelfRef = [&](const std::shared_ptr<TypeFunc> &signature) {
+    std::vector<std::shared_ptr<Type>> args = {selfRefType};
+    args.insert(args.end(), signature->args.begin(), signature->args.end());
+    return globalTypeTable->getFuncType(signature->return_type, args);
+  };
+
+  class_new_type->methods_types.clear();
   for (auto &meth : methods) {
     if (meth->getKind() == E_Constructor_Decl) {
       auto method = std::dynamic_pointer_cast<ConstrDecl>(meth);
       method->args.emplace(method->args.begin(), thisParam);
+      method->signature = withSelfRef(method->signature);
+      class_new_type->methods_types.push_back(method->signature);
       meth = method;
     } else {
       auto method = std::dynamic_pointer_cast<MethodDecl>(meth);
       method->args.emplace(method->args.begin(), thisParam);
+      method->signature = withSelfRef(method->signature);
+      class_new_type->methods_types.push_back(method->signature);
       meth = method;
     }
   }
@@ -1019,6 +1077,7 @@ std::shared_ptr<ClassDecl> Parser::parseClassDecl() {
 
   auto class_stmt = std::make_shared<ClassDecl>(class_name, class_new_type,
                                                 fields, methods);
+  class_stmt->scope = class_scope;
   if (base_class) {
     auto baseClassDecl = std::static_pointer_cast<ClassDecl>(base_class);
     class_stmt->base_class = baseClassDecl;
@@ -1053,41 +1112,25 @@ std::shared_ptr<ClassDecl> Parser::parseClassDecl() {
 
       std::string newName = (class_name + "_" + methodRealName);
 
-      // if overriden -> break
+      // overriden -> keep the derived one, copy the rest
       if (std::ranges::any_of(
         class_stmt->methods,
         [&](auto m) { return m->getName() == newName; })) {
-        break;
+        continue;
         }
 
-      auto m = *std::dynamic_pointer_cast<MethodDecl>(meth);
+      // a copy only names the method in a child class,
+      // code of the base one is shared (see CodeGenVisitor)
+      auto original = std::dynamic_pointer_cast<MethodDecl>(meth);
+      auto m = *original;
       m.setName(newName);
+      m.isInherited = true;
+      m.original = original->isInherited ? original->original : original;
       auto newDecl = std::make_shared<MethodDecl>(m);
       class_stmt->methods.emplace(class_stmt->methods.begin(), newDecl);
 
-      // @note when we copySimbols from base class scope
-      // they still have old scope data like Name etc.
-      // so we need to replace them with new Decls
-      // being aware of shared_ptr in SymbolInfo changing
-
       // update scope
       current_scope->addSymbol(newName, newDecl);
-
-      // emplace scope of inherited method
-      // into a Scope of a child class
-      // - get original scope from base class scope
-      // - copy it, change name
-
-      auto &children = current_scope->getChildren();
-      for (auto &child : children) {
-        if (child->getKind() == SCOPE_METHOD && child->external && child->getName() == meth->getName()) {
-          auto _child = std::make_shared<Scope<Entity>>(*child);
-          _child->setName(newName);
-          _child->external = false;
-          _child->setParent(current_scope);
-          child = std::move(_child);
-        }
-      }
     }
     // - add them into child
   }
@@ -1097,6 +1140,142 @@ std::shared_ptr<ClassDecl> Parser::parseClassDecl() {
   return class_stmt;
 }
 
+void Parser::parseGenericClass(int start, const std::string &name) {
+  next(); // eat '['
+  std::vector<std::string> params;
+  while (peek()->kind == TOKEN_IDENTIFIER) {
+    params.push_back(std::get<std::string>(next()->value));
+    if (peek()->kind == TOKEN_COMMA)
+      next(); // eat ','
+  }
+  next(); // eat ']'
+
+  // is, then, loop and else without if open a block, end closes it
+  int depth = 0;
+  for (auto token = next(); token && token->kind != TOKEN_EOF; token = next()) {
+    if (token->kind == TOKEN_BBEGIN || token->kind == TOKEN_THEN ||
+        token->kind == TOKEN_LOOP ||
+        (token->kind == TOKEN_ELSE && peek()->kind != TOKEN_IF))
+      depth++;
+    else if (token->kind == TOKEN_BEND && --depth == 0)
+      break;
+  }
+
+  std::vector<Token> body;
+  for (int i = start; i <= tokenPos; i++)
+    body.push_back(*tokens[i]);
+  globalTypeTable->addType(
+      moduleName, name,
+      std::make_shared<TypeGenericClass>(name, params, std::move(body)));
+}
+
+std::shared_ptr<Type>
+Parser::instantiate(const std::shared_ptr<TypeGenericClass> &generic,
+                    const std::vector<std::shared_ptr<Type>> &args) {
+  if (args.size() != generic->params.size() ||
+      std::ranges::find(args, nullptr) != args.end())
+    return nullptr;
+
+  std::string name = generic->name + "[";
+  for (size_t i = 0; i < args.size(); i++)
+    name += (i ? "," : "") + args[i]->name;
+  name += "]";
+
+  // an own copy per module, an object file of each
+  // has its methods, a linker keeps one of them
+  auto &table = globalTypeTable->types[moduleName];
+  if (table.exists(name))
+    return table.getType(name);
+  // declared ahead, so List[T] in a body of List is this
+  // very type (next : access List[T]), parseClassDecl fills it
+  table.types[name] = std::make_shared<TypeClass>(
+      name, std::vector<std::shared_ptr<Type>>{},
+      std::vector<std::shared_ptr<TypeFunc>>{});
+
+  std::vector<std::unique_ptr<Token>> replay;
+  for (const auto &token : generic->body)
+    replay.push_back(std::make_unique<Token>(token));
+  replay.push_back(std::make_unique<Token>(
+      TOKEN_EOF, generic->body.back().line, generic->body.back().column));
+
+  auto savedTokens = std::exchange(tokens, std::move(replay));
+  auto savedPos = std::exchange(tokenPos, -1);
+  auto savedArguments = std::exchange(typeArguments, {});
+  auto savedScope = globalSymbolTable->getCurrentScope();
+
+  // an instance of a nested one may bind the same name
+  std::unordered_map<std::string, std::shared_ptr<Type>> shadowed;
+  for (size_t i = 0; i < args.size(); i++) {
+    auto &param = generic->params[i];
+    if (table.exists(param))
+      shadowed[param] = table.types[param];
+    table.types[param] = args[i];
+    typeArguments[param] = args[i];
+  }
+
+  if (auto moduleScope = globalSymbolTable->getModuleScope(savedScope))
+    globalSymbolTable->setCurrentScope(moduleScope);
+  instanceName = name;
+  auto instance = parseClassDecl();
+
+  for (const auto &param : generic->params) {
+    if (auto it = shadowed.find(param); it != shadowed.end())
+      table.types[param] = it->second;
+    else
+      table.types.erase(param);
+  }
+  globalSymbolTable->setCurrentScope(savedScope);
+  typeArguments = std::move(savedArguments);
+  tokenPos = savedPos;
+  tokens = std::move(savedTokens);
+
+  // a failed instance is not kept as a type
+  if (!instance) {
+    table.types.erase(name);
+    return nullptr;
+  }
+  instance->isInstance = true;
+  instances.push_back(instance);
+  return table.getType(name);
+}
+
+Attributes Parser::parseAttributes() {
+  Attributes attributes;
+  std::unique_ptr<Token> token = peek();
+  if (token == nullptr || token->kind != TOKEN_LSBRACKET)
+    return attributes;
+  token = next(); // eat '['
+
+  token = peek();
+  while (token->kind == TOKEN_IDENTIFIER) {
+    token = next();
+    Attribute attr{std::get<std::string>(token->value), std::nullopt};
+
+    // align(64)
+    if (peek()->kind == TOKEN_LBRACKET) {
+      token = next();
+      token = next();
+      if (std::holds_alternative<int>(token->value))
+        attr.value = std::get<int>(token->value);
+      if (peek()->kind == TOKEN_RBRACKET)
+        token = next();
+    }
+    attributes.push_back(attr);
+
+    token = peek();
+    if (token->kind != TOKEN_COMMA)
+      break;
+    token = next();
+    token = peek();
+  }
+
+  // eat ']'
+  if (peek()->kind == TOKEN_RSBRACKET)
+    token = next();
+
+  return attributes;
+}
+
 std::shared_ptr<EnumDecl> Parser::parseEnumDecl() {
   std::unique_ptr<Token> token = peek();
   if (token == nullptr || token->kind != TOKEN_ENUM)
@@ -1112,11 +1291,14 @@ std::shared_ptr<EnumDecl> Parser::parseEnumDecl() {
     token = next();
     return std::make_shared<EnumDecl>("unknown_enum");
   }
-  auto enum_name = std::get<std::string>(token->value);
+  auto enum_name = std::get<std::string>(next()->value);
 
   globalSymbolTable->enterScope(SCOPE_ENUM, enum_name);
 
   auto enumDecl = std::make_shared<EnumDecl>(enum_name);
+  // items are numbered from 0 in order
+  if (peek()->kind == TOKEN_BBEGIN)
+    next(); // eat 'is'
   token = peek();
   while (token->kind != TOKEN_BEND) {
     token = next();
@@ -1181,19 +1363,18 @@ std::shared_ptr<FieldDecl> Parser::parseFieldDecl(size_t index) {
   } else {
     // token = next();
     if (isPointer) {
-      auto toType = globalTypeTable->types[moduleName].getType(
-        std::get<std::string>(token->value));
-      var_type = std::make_shared<TypeAccess>(toType);
+      auto toType = parseTypeName(*token);
+      var_type = globalTypeTable->getAccessType(toType);
       type_name = var_name; // alias a type by the variable name
       globalTypeTable->addType(moduleName, type_name, var_type);
     } else {
-      var_type = globalTypeTable->types[moduleName].getType(
-          std::get<std::string>(token->value));
+      var_type = parseTypeName(*token);
     }
   }
 
-  // composite container type
-  if (peek()->kind == TOKEN_LSBRACKET) {
+  // composite container type, `[` of a next line
+  // starts attributes of a next declaration
+  if (peek()->kind == TOKEN_LSBRACKET && peek()->line == token->line) {
 
     token = next(); // eat '['
 
@@ -1205,7 +1386,7 @@ std::shared_ptr<FieldDecl> Parser::parseFieldDecl(size_t index) {
 
       auto toType = globalTypeTable->types[moduleName].getType(
   el_type_name);
-      var_type = std::make_shared<TypeAccess>(toType);
+      var_type = globalTypeTable->getAccessType(toType);
       type_name = var_name; // alias a type by the variable name
       globalTypeTable->addType(moduleName, type_name, var_type);
       el_type = var_type;
@@ -1213,16 +1394,8 @@ std::shared_ptr<FieldDecl> Parser::parseFieldDecl(size_t index) {
       el_type = globalTypeTable->getType(moduleName, el_type_name);
     }
 
-    // @note <TypeList> is safe, because it has only el_type field
-    auto var_type_array = std::make_shared<TypeList>(el_type);
-    var_type_array->el_type = std::move(el_type);
-
-    // size_t array_size = 0;
-
     // "," SIZE
     if (peek()->kind == TOKEN_COMMA) {
-      auto var_type_const_array = std::make_shared<TypeArray>();
-      var_type_const_array->el_type = std::move(el_type);
       token = next(); // eat ','
 
       token = peek();
@@ -1230,30 +1403,14 @@ std::shared_ptr<FieldDecl> Parser::parseFieldDecl(size_t index) {
       token = next();
       size_t array_size = std::get<int>(token->value);
 
-      var_type_const_array->el_type = std::move(var_type_array->el_type);
-      var_type_const_array->size = array_size;
-
-      // Array type cant be shared, because arrays
-      // have different length
-      // taken from c++ primer
-      // `"The number of elements in an array is part of the array's type."`
-      // so we add a new array type when we encounter a decl of array
-      // indexed by a var name ?
-
-      globalTypeTable->addType(moduleName, var_name, var_type_const_array);
-
-      var_type = var_type_const_array;
+      // "The number of elements in an array is part of the array's type."
+      // so arrays are uniqued by (element type, size)
+      // and the decl aliases the canonical type by its name
+      var_type = globalTypeTable->getArrayType(el_type, array_size);
     } else {
-      // Array type cant be shared, because arrays
-      // have different length
-      // taken from c++ primer
-      // `"The number of elements in an array is part of the array's type."`
-      // so we add a new array type when we encounter a decl of array
-      // indexed by a var name ?
-      globalTypeTable->addType(moduleName, var_name, var_type_array);
-
-      var_type = var_type_array;
+      var_type = globalTypeTable->getListType(el_type);
     }
+    globalTypeTable->addType(moduleName, var_name, var_type);
 
     token = next(); // eat ']'
   }
@@ -1275,6 +1432,8 @@ std::shared_ptr<WhileSTMT> Parser::parseWhileStatement() {
     return nullptr;
   token = next(); // eat 'while'
 
+  auto while_scope = globalSymbolTable->enterScope(SCOPE_LOOP, "while_loop");
+
   token = peek();
   std::shared_ptr<Expression> condition;
   if (token->kind != TOKEN_IDENTIFIER && token->kind != TOKEN_INT_NUMBER &&
@@ -1296,7 +1455,11 @@ std::shared_ptr<WhileSTMT> Parser::parseWhileStatement() {
   } else
     block_body = parseBlock(BLOCK_IN_WHILE);
 
-  return std::make_shared<WhileSTMT>(condition, block_body);
+  globalSymbolTable->exitScope();
+
+  auto while_stmt = std::make_shared<WhileSTMT>(condition, block_body);
+  while_stmt->scope = while_scope;
+  return while_stmt;
 }
 
 std::shared_ptr<ForSTMT> Parser::parseForStatement() {
@@ -1317,7 +1480,7 @@ std::shared_ptr<ForSTMT> Parser::parseForStatement() {
     return std::make_shared<ForSTMT>();
   }
 
-  globalSymbolTable->enterScope(SCOPE_LOOP, "for_loop");
+  auto for_scope = globalSymbolTable->enterScope(SCOPE_LOOP, "for_loop");
 
   auto varRef = std::make_shared<VarRefEXP>(std::get<std::string>(next()->value));
 
@@ -1351,7 +1514,9 @@ std::shared_ptr<ForSTMT> Parser::parseForStatement() {
 
   globalSymbolTable->exitScope();
 
-  return std::make_shared<ForSTMT>(varRef, cond, post, block_body);
+  auto for_stmt = std::make_shared<ForSTMT>(varRef, cond, post, block_body);
+  for_stmt->scope = for_scope;
+  return for_stmt;
 
   // auto varAssign = std::make_shared<AssignmentSTMT>(std::move(varRef), )
 }
@@ -1663,10 +1828,9 @@ std::shared_ptr<Expression> Parser::parseStaticAccess(std::shared_ptr<Expression
     token = next();
 
     switch (left->getKind()) {
-        case E_Enum_Decl:
         case E_Enum_Reference: {
-            auto node_as_var = std::static_pointer_cast<VarRefEXP>(left);
-            return std::make_shared<EnumRefEXP>(node_as_var->getName(), std::get<std::string>(token->value));
+            auto node_as_enum = std::static_pointer_cast<EnumRefEXP>(left);
+            return std::make_shared<EnumRefEXP>(node_as_enum->enumName, std::get<std::string>(token->value));
         }
         case E_Class_Decl:
         case E_Class_Name: {
@@ -1741,6 +1905,12 @@ std::shared_ptr<Expression> Parser::parseMemberAccess(std::shared_ptr<Expression
             } else {
                 next(); // eat ')'
             }
+        } else if (comp->parts.back()->getKind() == E_Class_Name &&
+                   after_dot && after_dot->getName() == "size") {
+            // T.size, a size of a type, as T.Size()
+            auto size = std::make_shared<MethodCallEXP>("Size");
+            size->left = comp->parts.back();
+            comp->addExpression(size);
         } else {
             // This is a field access
             auto field_name = std::static_pointer_cast<VarRefEXP>(after_dot)->getName();
@@ -1853,7 +2023,7 @@ std::shared_ptr<ParameterDecl> Parser::parseParameterDecl() {
 
       auto toType = globalTypeTable->types[moduleName].getType(
   el_type_name);
-      param_type = std::make_shared<TypeAccess>(toType);
+      param_type = globalTypeTable->getAccessType(toType);
       type_name = param_name; // alias a type by the variable name
       globalTypeTable->addType(moduleName, type_name, param_type);
       el_type = param_type;
@@ -1861,16 +2031,8 @@ std::shared_ptr<ParameterDecl> Parser::parseParameterDecl() {
       el_type = globalTypeTable->getType(moduleName, el_type_name);
     }
 
-    // @note <TypeList> is safe, because it has only el_type field
-    auto var_type_array = std::make_shared<TypeList>(el_type);
-    var_type_array->el_type = std::move(el_type);
-
-    // size_t array_size = 0;
-
     // "," SIZE
     if (peek()->kind == TOKEN_COMMA) {
-      auto var_type_const_array = std::make_shared<TypeArray>();
-      var_type_const_array->el_type = std::move(el_type);
       token = next(); // eat ','
 
       token = peek();
@@ -1878,30 +2040,14 @@ std::shared_ptr<ParameterDecl> Parser::parseParameterDecl() {
       token = next();
       size_t array_size = std::get<int>(token->value);
 
-      var_type_const_array->el_type = std::move(var_type_array->el_type);
-      var_type_const_array->size = array_size;
-
-      // Array type cant be shared, because arrays
-      // have different length
-      // taken from c++ primer
-      // `"The number of elements in an array is part of the array's type."`
-      // so we add a new array type when we encounter a decl of array
-      // indexed by a var name ?
-
-      globalTypeTable->addType(moduleName, param_name, var_type_const_array);
-
-      param_type = var_type_const_array;
+      // "The number of elements in an array is part of the array's type."
+      // so arrays are uniqued by (element type, size)
+      // and the decl aliases the canonical type by its name
+      param_type = globalTypeTable->getArrayType(el_type, array_size);
     } else {
-      // Array type cant be shared, because arrays
-      // have different length
-      // taken from c++ primer
-      // `"The number of elements in an array is part of the array's type."`
-      // so we add a new array type when we encounter a decl of array
-      // indexed by a var name ?
-      globalTypeTable->addType(moduleName, param_name, var_type_array);
-
-      param_type = var_type_array;
+      param_type = globalTypeTable->getListType(el_type);
     }
+    globalTypeTable->addType(moduleName, param_name, param_type);
 
     token = next(); // eat ']'
   }
@@ -1925,14 +2071,12 @@ std::shared_ptr<ParameterDecl> Parser::parseParameterDecl() {
     } else {
       // token = next();
       if (isPointer) {
-        auto toType = globalTypeTable->types[moduleName].getType(
-          std::get<std::string>(token->value));
-        param_type = std::make_shared<TypeAccess>(toType);
+        auto toType = parseTypeName(*token);
+        param_type = globalTypeTable->getAccessType(toType);
         type_name = param_name; // alias a type by the variable name
         globalTypeTable->addType(moduleName, type_name, param_type);
       } else {
-        param_type = globalTypeTable->types[moduleName].getType(
-            std::get<std::string>(token->value));
+        param_type = parseTypeName(*token);
       }
     }
   }
@@ -1947,6 +2091,48 @@ std::shared_ptr<ParameterDecl> Parser::parseParameterDecl() {
   return paramDecl;
 }
 
+std::shared_ptr<Type> Parser::parseReturnType(const Token &token) {
+  // pointer, e.g. to an object made on the heap
+  if (token.kind == TOKEN_ACCESS) {
+    auto toType = parseTypeName(*next());
+    return globalTypeTable->getAccessType(toType);
+  }
+
+  auto type_name = std::get<std::string>(token.value);
+  // fixed size array, e.g. a precomputed table
+  if (type_name == "Array" && peek()->kind == TOKEN_LSBRACKET) {
+    next(); // eat '['
+    auto el_type =
+        globalTypeTable->getType(moduleName, std::get<std::string>(next()->value));
+    next(); // eat ','
+    size_t array_size = std::get<int>(next()->value);
+    next(); // eat ']'
+    return globalTypeTable->getArrayType(el_type, array_size);
+  }
+  if (peek()->kind == TOKEN_LSBRACKET)
+    return parseTypeName(token);
+  return globalTypeTable->getType(moduleName, type_name);
+}
+
+std::shared_ptr<Type> Parser::parseTypeName(const Token &token) {
+  auto name = std::get_if<std::string>(&token.value);
+  if (!name)
+    return nullptr;
+  auto type = globalTypeTable->types[moduleName].getType(*name);
+  auto generic = std::dynamic_pointer_cast<TypeGenericClass>(type);
+  if (!generic || peek()->kind != TOKEN_LSBRACKET)
+    return type;
+
+  next(); // eat '['
+  std::vector<std::shared_ptr<Type>> args = {parseTypeName(*next())};
+  while (peek()->kind == TOKEN_COMMA) {
+    next(); // eat ','
+    args.push_back(parseTypeName(*next()));
+  }
+  next(); // eat ']'
+  return instantiate(generic, args);
+}
+
 void Parser::parseParameters(const std::shared_ptr<FuncDecl> &funcDecl) {
   std::unique_ptr<Token> token = peek();
   if (token == nullptr || token->kind != TOKEN_LBRACKET) {
@@ -2334,6 +2520,19 @@ std::shared_ptr<Expression> Parser::parsePrimary() {
   case TOKEN_PRINT: {
     auto var = globalSymbolTable->getCurrentScope()->lookup(
         std::get<std::string>(token->value));
+    // T in an instance of a template, Box[Integer] of Box[Integer](42)
+    if (!var) {
+      auto name = std::get<std::string>(token->value);
+      std::shared_ptr<Type> type;
+      if (auto bound = typeArguments.find(name); bound != typeArguments.end())
+        type = bound->second;
+      else if (peek()->kind == TOKEN_LSBRACKET &&
+               std::dynamic_pointer_cast<TypeGenericClass>(
+                   globalTypeTable->types[moduleName].getType(name)))
+        type = parseTypeName(*token);
+      if (type)
+        return std::make_shared<ClassNameEXP>(type->name);
+    }
     if (!var) {
       // PARSER_ERR(sm.getLastFilePath().c_str(), "Variable not found in scope\n");
       expr = std::make_shared<DummyExpression>(std::get<std::string>(token->value));
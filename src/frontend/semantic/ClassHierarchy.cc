@@ -0,0 +1,169 @@
+#include "frontend/semantic/ClassHierarchy.h"
+
+ClassHierarchy::ClassHierarchy(
+    const std::shared_ptr<Scope<Entity>> &globalScope) {
+  for (const auto &module : globalScope->getChildren()) {
+    if (module->getKind() != SCOPE_MODULE)
+      continue;
+    for (auto &[name, symbol] : module->getSymbols()) {
+      if (symbol.decl && symbol.decl->getKind() == E_Class_Decl) {
+        auto classDecl = std::static_pointer_cast<ClassDecl>(symbol.decl);
+        classes[classDecl->getName()] = classDecl.get();
+      }
+    }
+  }
+
+  for (const auto &[name, classDecl] : classes) {
+    if (classDecl->base_class)
+      subclasses[classDecl->base_class.get()].push_back(classDecl);
+  }
+  for (const auto &[name, classDecl] : classes)
+    build(*classDecl);
+}
+
+ClassDecl *ClassHierarchy::classOf(const std::string &name) const {
+  auto it = classes.find(name);
+  return it != classes.end() ? it->second : nullptr;
+}
+
+std::string ClassHierarchy::methodName(const ClassDecl &classDecl,
+                                       const Decl &method) {
+  auto prefix = classDecl.getName() + "_";
+  const auto &name = method.getName();
+  if (name.starts_with(prefix))
+    return name.substr(prefix.size());
+  return name;
+}
+
+// base first, then slots it adds
+void ClassHierarchy::build(ClassDecl &classDecl) {
+  if (origins.contains(&classDecl))
+    return;
+
+  std::vector<std::shared_ptr<MethodDecl>> vtable;
+  std::vector<const MethodDecl *> origin;
+  auto methodOf = [&](const std::string &name) -> std::shared_ptr<MethodDecl> {
+    for (const auto &decl : classDecl.methods) {
+      auto method = std::dynamic_pointer_cast<MethodDecl>(decl);
+      if (method && !method->isStatic &&
+          methodName(classDecl, *method) == name)
+        return method;
+    }
+    return nullptr;
+  };
+
+  if (auto base = classDecl.base_class) {
+    build(*base);
+    vtable = base->vtable;
+    origin = origins.at(base.get());
+    for (size_t slot = 0; slot < vtable.size(); slot++) {
+      // an override or an inherited copy
+      auto method = methodOf(methodName(*base, *vtable[slot]));
+      if (!method)
+        continue;
+      method->isVirtual = true;
+      vtable[slot] = method;
+      if (!method->isInherited)
+        origin[slot] = method.get();
+    }
+  }
+
+  for (const auto &decl : classDecl.methods) {
+    auto method = std::dynamic_pointer_cast<MethodDecl>(decl);
+    if (!method || !method->isVirtual || method->isInherited ||
+        method->isStatic)
+      continue;
+    if (std::ranges::find(vtable, method) != vtable.end())
+      continue;
+    vtable.push_back(method);
+    origin.push_back(method.get());
+  }
+
+  classDecl.vtable = std::move(vtable);
+  origins[&classDecl] = std::move(origin);
+}
+
+int ClassHierarchy::slotOf(const ClassDecl &classDecl,
+                           const std::string &method) const {
+  for (size_t slot = 0; slot < classDecl.vtable.size(); slot++) {
+    if (methodName(classDecl, *classDecl.vtable[slot]) == method)
+      return static_cast<int>(slot);
+  }
+  return -1;
+}
+
+void ClassHierarchy::collectOrigins(
+    const ClassDecl &classDecl, size_t slot,
+    std::vector<const MethodDecl *> &result) const {
+  result.push_back(origins.at(&classDecl)[slot]);
+  if (auto it = subclasses.find(&classDecl); it != subclasses.end()) {
+    for (auto subclass : it->second)
+      collectOrigins(*subclass, slot, result);
+  }
+}
+
+std::vector<const MethodDecl *>
+ClassHierarchy::implementations(const ClassDecl &classDecl, size_t slot) const {
+  std::vector<const MethodDecl *> result;
+  if (slot < classDecl.vtable.size())
+    collectOrigins(classDecl, slot, result);
+  return result;
+}
+
+int ClassHierarchy::dispatch(const ClassDecl &classDecl,
+                             const std::string &method) const {
+  auto slot = slotOf(classDecl, method);
+  if (slot < 0)
+    return -1;
+
+  std::vector<const MethodDecl *> targets;
+  collectOrigins(classDecl, slot, targets);
+  bool single = std::ranges::all_of(
+      targets, [&](auto target) { return target == targets.front(); });
+  return single ? -1 : slot;
+}
+
+std::vector<std::string>
+ClassHierarchy::check(const ModuleDecl &module) const {
+  std::vector<std::string> errors;
+  for (const auto &child : module.children) {
+    if (child->getKind() != E_Class_Decl)
+      continue;
+    auto classDecl = std::static_pointer_cast<ClassDecl>(child);
+    auto base = classDecl->base_class;
+
+    for (const auto &decl : classDecl->methods) {
+      auto method = std::dynamic_pointer_cast<MethodDecl>(decl);
+      if (!method || method->isInherited)
+        continue;
+
+      auto slot = base ? slotOf(*base, methodName(*classDecl, *method)) : -1;
+      if (slot < 0) {
+        if (method->isOverride)
+          errors.push_back("'" + method->getName() +
+                           "' overrides no virtual method");
+        continue;
+      }
+
+      // `this` differs, types of other modules are other
+      // objects, hence by name
+      auto overridden = base->vtable[slot];
+      const auto &own = method->signature;
+      const auto &other = overridden->signature;
+      auto sameType = [](const std::shared_ptr<Type> &a,
+                         const std::shared_ptr<Type> &b) {
+        return a == b || (a && b && a->kind == b->kind && a->name == b->name);
+      };
+      bool same = own && other && !own->args.empty() &&
+                  sameType(own->return_type, other->return_type) &&
+                  own->args.size() == other->args.size() &&
+                  std::equal(own->args.begin() + 1, own->args.end(),
+                             other->args.begin() + 1, sameType);
+      if (!same)
+        errors.push_back("Signature of '" + method->getName() +
+                         "' does not match overridden '" +
+                         overridden->getName() + "'");
+    }
+  }
+  return errors;
+}
@@ -0,0 +1,376 @@
+#include "frontend/semantic/ConstValue.h"
+
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// two's complement wrap around to `bits`
+int64_t wrap(uint64_t value, size_t bits) {
+  if (bits >= 64)
+    return static_cast<int64_t>(value);
+  auto shift = 64 - bits;
+  return static_cast<int64_t>(value << shift) >> shift;
+}
+
+int64_t minOf(size_t bits) {
+  if (bits >= 64)
+    return std::numeric_limits<int64_t>::min();
+  return -(int64_t(1) << (bits - 1));
+}
+
+int64_t maxOf(size_t bits) {
+  if (bits >= 64)
+    return std::numeric_limits<int64_t>::max();
+  return (int64_t(1) << (bits - 1)) - 1;
+}
+
+// width of a builtin integer type, 0 for anything else
+size_t intBits(const Type &type) {
+  switch (type.kind) {
+  case TYPE_INT:
+  case TYPE_I16:
+  case TYPE_I64:
+  case TYPE_BYTE:
+    break;
+  default:
+    return 0;
+  }
+  auto builtin = dynamic_cast<const TypeBuiltin *>(&type);
+  return builtin ? builtin->bitsize : 0;
+}
+
+// a wrapped result, or nullopt if an overflow
+// must trap at runtime, see --overflow=
+std::optional<ConstValue> ofArith(int64_t result, bool overflowed,
+                                  size_t bits, bool wraps) {
+  if (!wraps && (overflowed || result < minOf(bits) || result > maxOf(bits)))
+    return std::nullopt;
+  return ConstValue::ofInt(result, bits);
+}
+
+std::optional<ConstValue> addInt(int64_t a, int64_t b, size_t bits,
+                                 bool wraps) {
+  int64_t result;
+  bool overflowed = __builtin_add_overflow(a, b, &result);
+  return ofArith(result, overflowed, bits, wraps);
+}
+
+std::optional<ConstValue> subInt(int64_t a, int64_t b, size_t bits,
+                                 bool wraps) {
+  int64_t result;
+  bool overflowed = __builtin_sub_overflow(a, b, &result);
+  return ofArith(result, overflowed, bits, wraps);
+}
+
+std::optional<ConstValue> mulInt(int64_t a, int64_t b, size_t bits,
+                                 bool wraps) {
+  int64_t result;
+  bool overflowed = __builtin_mul_overflow(a, b, &result);
+  return ofArith(result, overflowed, bits, wraps);
+}
+
+// trap or UB at runtime, keep it there
+bool isDivisionSafe(int64_t a, int64_t b, size_t bits) {
+  return b != 0 && !(a == minOf(bits) && b == -1);
+}
+
+} // namespace
+
+ConstValue ConstValue::ofInt(int64_t value, size_t bits) {
+  ConstValue v;
+  v.kind = CV_INT;
+  v.i = wrap(static_cast<uint64_t>(value), bits);
+  v.bits = bits;
+  return v;
+}
+
+ConstValue ConstValue::ofReal(double value) {
+  ConstValue v;
+  v.kind = CV_REAL;
+  v.r = value;
+  return v;
+}
+
+ConstValue ConstValue::ofBool(bool value) {
+  ConstValue v;
+  v.kind = CV_BOOL;
+  v.b = value;
+  return v;
+}
+
+ConstValue ConstValue::ofArray(std::vector<ConstValue> elements) {
+  ConstValue v;
+  v.kind = CV_ARRAY;
+  v.elements = std::move(elements);
+  return v;
+}
+
+std::optional<ConstValue> literalValue(const Expression &expr) {
+  switch (expr.getKind()) {
+  case E_Integer_Literal: {
+    auto &literal = static_cast<const IntLiteralEXP &>(expr);
+    return ConstValue::ofInt(literal.getValue(), literal.getByteSize());
+  }
+  case E_Real_Literal:
+    return ConstValue::ofReal(
+        static_cast<const RealLiteralEXP &>(expr).getValue());
+  case E_Boolean_Literal:
+    return ConstValue::ofBool(
+        static_cast<const BoolLiteralEXP &>(expr).getValue());
+  case E_Array_Literal: {
+    std::vector<ConstValue> elements;
+    for (const auto &element :
+         static_cast<const ArrayLiteralExpr &>(expr).elements) {
+      auto value = element ? literalValue(*element) : std::nullopt;
+      if (!value || value->kind == ConstValue::CV_ARRAY)
+        return std::nullopt;
+      elements.push_back(*value);
+    }
+    return ConstValue::ofArray(std::move(elements));
+  }
+  default:
+    return std::nullopt;
+  }
+}
+
+std::optional<ConstValue> evalBuiltin(BuiltinMethod method,
+                                      const ConstValue &self,
+                                      const ConstValue *arg, bool wraps) {
+  if (self.kind == ConstValue::CV_INT) {
+    auto bits = self.bits;
+    auto a = self.i;
+
+    if (method == BM_UNARY_MINUS)
+      return subInt(0, a, bits, wraps);
+
+    if (!arg || arg->kind != ConstValue::CV_INT || arg->bits != bits)
+      return std::nullopt;
+    auto b = arg->i;
+
+    switch (method) {
+    case BM_PLUS:
+      return addInt(a, b, bits, wraps);
+    case BM_MINUS:
+      return subInt(a, b, bits, wraps);
+    case BM_MULT:
+      return mulInt(a, b, bits, wraps);
+    case BM_DIV:
+    case BM_REM:
+      if (!isDivisionSafe(a, b, bits))
+        return std::nullopt;
+      return ConstValue::ofInt(method == BM_DIV ? a / b : a % b, bits);
+    case BM_LESS:
+      return ConstValue::ofBool(a < b);
+    case BM_GREATER:
+      return ConstValue::ofBool(a > b);
+    case BM_EQUAL:
+      return ConstValue::ofBool(a == b);
+    default:
+      return std::nullopt;
+    }
+  }
+
+  if (self.kind == ConstValue::CV_REAL) {
+    auto a = self.r;
+
+    if (method == BM_UNARY_MINUS)
+      return ConstValue::ofReal(-a);
+
+    if (!arg || arg->kind != ConstValue::CV_REAL)
+      return std::nullopt;
+    auto b = arg->r;
+
+    switch (method) {
+    case BM_PLUS:
+      return ConstValue::ofReal(a + b);
+    case BM_MINUS:
+      return ConstValue::ofReal(a - b);
+    case BM_MULT:
+      return ConstValue::ofReal(a * b);
+    case BM_DIV:
+      return ConstValue::ofReal(a / b);
+    case BM_REM:
+      return ConstValue::ofReal(std::fmod(a, b));
+    case BM_LESS:
+      return ConstValue::ofBool(a < b);
+    case BM_GREATER:
+      return ConstValue::ofBool(a > b);
+    case BM_EQUAL:
+      return ConstValue::ofBool(a == b);
+    default:
+      return std::nullopt;
+    }
+  }
+
+  if (self.kind == ConstValue::CV_BOOL) {
+    auto a = self.b;
+
+    if (method == BM_NOT)
+      return ConstValue::ofBool(!a);
+
+    if (!arg || arg->kind != ConstValue::CV_BOOL)
+      return std::nullopt;
+    auto b = arg->b;
+
+    switch (method) {
+    case BM_AND:
+      return ConstValue::ofBool(a && b);
+    case BM_OR:
+      return ConstValue::ofBool(a || b);
+    case BM_EQUAL:
+      return ConstValue::ofBool(a == b);
+    default:
+      return std::nullopt;
+    }
+  }
+
+  return std::nullopt;
+}
+
+std::optional<ConstValue> evalBinary(OperatorKind op, const ConstValue &left,
+                                     const ConstValue &right, bool wraps) {
+  if (left.kind == ConstValue::CV_INT && right.kind == ConstValue::CV_INT &&
+      left.bits == right.bits) {
+    auto bits = left.bits;
+    auto a = left.i;
+    auto b = right.i;
+
+    switch (op) {
+    case OP_PLUS:
+      return addInt(a, b, bits, wraps);
+    case OP_MINUS:
+      return subInt(a, b, bits, wraps);
+    case OP_MULTIPLY:
+      return mulInt(a, b, bits, wraps);
+    case OP_DIVIDE:
+    case OP_MODULUS:
+      if (!isDivisionSafe(a, b, bits))
+        return std::nullopt;
+      return ConstValue::ofInt(op == OP_DIVIDE ? a / b : a % b, bits);
+    case OP_BIT_AND:
+      return ConstValue::ofInt(a & b, bits);
+    case OP_BIT_OR:
+      return ConstValue::ofInt(a | b, bits);
+    case OP_BIT_XOR:
+      return ConstValue::ofInt(a ^ b, bits);
+    case OP_BIT_LSHIFT:
+      if (b < 0 || static_cast<uint64_t>(b) >= bits)
+        return std::nullopt;
+      return ConstValue::ofInt(uint64_t(a) << b, bits);
+    case OP_BIT_RSHIFT:
+      if (b < 0 || static_cast<uint64_t>(b) >= bits)
+        return std::nullopt;
+      return ConstValue::ofInt(a >> b, bits);
+    default:
+      return std::nullopt;
+    }
+  }
+
+  if (left.kind == ConstValue::CV_BOOL && right.kind == ConstValue::CV_BOOL) {
+    switch (op) {
+    case OP_LOGIC_AND:
+      return ConstValue::ofBool(left.b && right.b);
+    case OP_LOGIC_OR:
+      return ConstValue::ofBool(left.b || right.b);
+    default:
+      return std::nullopt;
+    }
+  }
+
+  return std::nullopt;
+}
+
+std::optional<ConstValue> evalUnary(OperatorKind op,
+                                    const ConstValue &operand, bool wraps) {
+  switch (operand.kind) {
+  case ConstValue::CV_INT: {
+    switch (op) {
+    case OP_UNARY_MINUS:
+    case OP_MINUS:
+      return subInt(0, operand.i, operand.bits, wraps);
+    case OP_BIT_NOT:
+      return ConstValue::ofInt(~operand.i, operand.bits);
+    default:
+      return std::nullopt;
+    }
+  }
+  case ConstValue::CV_REAL:
+    if (op == OP_UNARY_MINUS || op == OP_MINUS)
+      return ConstValue::ofReal(-operand.r);
+    return std::nullopt;
+  case ConstValue::CV_BOOL:
+    if (op == OP_LOGIC_NOT || op == OP_NOT)
+      return ConstValue::ofBool(!operand.b);
+    return std::nullopt;
+  default:
+    return std::nullopt;
+  }
+}
+
+std::optional<ConstValue> evalConversion(const ConstValue &from,
+                                         const Type &to) {
+  if (to.kind == TYPE_REAL) {
+    if (from.kind == ConstValue::CV_INT)
+      return ConstValue::ofReal(static_cast<double>(from.i));
+    if (from.kind == ConstValue::CV_REAL)
+      return from;
+    return std::nullopt;
+  }
+
+  size_t bits = intBits(to);
+  if (bits == 0)
+    return std::nullopt;
+
+  // only widening, as codegen does (sext)
+  if (from.kind == ConstValue::CV_INT && from.bits <= bits)
+    return ConstValue::ofInt(from.i, bits);
+
+  // fptosi is poison out of range
+  if (from.kind == ConstValue::CV_REAL) {
+    auto value = std::trunc(from.r);
+    if (!std::isfinite(value) || value < static_cast<double>(minOf(bits)) ||
+        value > static_cast<double>(maxOf(bits)))
+      return std::nullopt;
+    return ConstValue::ofInt(static_cast<int64_t>(value), bits);
+  }
+
+  return std::nullopt;
+}
+
+std::optional<ConstValue> coerce(const ConstValue &value, const Type &to) {
+  if (auto bits = intBits(to)) {
+    if (value.kind != ConstValue::CV_INT)
+      return std::nullopt;
+    return ConstValue::ofInt(value.i, bits);
+  }
+
+  switch (to.kind) {
+  case TYPE_REAL:
+    if (value.kind != ConstValue::CV_REAL)
+      return std::nullopt;
+    return value;
+  case TYPE_BOOL:
+    if (value.kind != ConstValue::CV_BOOL)
+      return std::nullopt;
+    return value;
+  case TYPE_ARRAY: {
+    auto &array = static_cast<const TypeArray &>(to);
+    if (value.kind != ConstValue::CV_ARRAY || !array.el_type ||
+        value.elements.size() != array.size)
+      return std::nullopt;
+    auto result = value;
+    for (auto &element : result.elements) {
+      if (element.kind == ConstValue::CV_UNSET)
+        continue;
+      auto coerced = coerce(element, *array.el_type);
+      if (!coerced)
+        return std::nullopt;
+      element = *coerced;
+    }
+    return result;
+  }
+  default:
+    return std::nullopt;
+  }
+}
@@ -0,0 +1,392 @@
+#include "frontend/semantic/ConstantFolder.h"
+#include "frontend/types/Builtins.h"
+
+namespace {
+
+bool isLiteral(const Expression &expr) {
+  switch (expr.getKind()) {
+  case E_Integer_Literal:
+  case E_Real_Literal:
+  case E_Boolean_Literal:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// value of a scalar literal operand
+std::optional<ConstValue> operandValue(const std::shared_ptr<Expression> &expr) {
+  if (!expr || !isLiteral(*expr))
+    return std::nullopt;
+  return literalValue(*expr);
+}
+
+} // namespace
+
+//========== LITERALS ==========
+
+std::shared_ptr<Expression>
+ConstantFolder::makeLiteral(const ConstValue &value,
+                            const std::shared_ptr<Type> &type) {
+  std::shared_ptr<Expression> literal;
+  switch (value.kind) {
+  case ConstValue::CV_INT:
+    literal = std::make_shared<IntLiteralEXP>(value.i, value.bits);
+    break;
+  case ConstValue::CV_REAL:
+    literal = std::make_shared<RealLiteralEXP>(value.r);
+    break;
+  case ConstValue::CV_BOOL:
+    literal = std::make_shared<BoolLiteralEXP>(value.b);
+    break;
+  case ConstValue::CV_ARRAY: {
+    auto array = std::dynamic_pointer_cast<TypeArray>(type);
+    if (!array || value.elements.empty())
+      return nullptr;
+    std::vector<std::shared_ptr<Expression>> elements;
+    for (const auto &element : value.elements) {
+      auto elementLiteral = makeLiteral(element, array->el_type);
+      if (!elementLiteral)
+        return nullptr;
+      elements.push_back(elementLiteral);
+    }
+    literal = std::make_shared<ArrayLiteralExpr>(std::move(elements));
+  } break;
+  default:
+    return nullptr;
+  }
+  literal->type = type ? type : literal->resolveType(typeTable, currentScope);
+  return literal;
+}
+
+std::shared_ptr<Expression>
+ConstantFolder::makeLiteral(const std::optional<ConstValue> &value,
+                            const Expression &replaced) {
+  return value ? makeLiteral(*value, replaced.type) : nullptr;
+}
+
+std::shared_ptr<Expression>
+ConstantFolder::copyLiteral(const Expression &literal) {
+  return makeLiteral(literalValue(literal), literal);
+}
+
+//========== FOLDING ==========
+
+std::shared_ptr<Expression>
+ConstantFolder::foldMethodCall(MethodCallEXP &node) {
+  if (!isBuiltinCall(node))
+    return nullptr;
+
+  auto self = operandValue(node.left);
+  if (!self)
+    return nullptr;
+
+  std::optional<ConstValue> arg;
+  if (!node.arguments.empty() && !(arg = operandValue(node.arguments[0])))
+    return nullptr;
+
+  return makeLiteral(evalBuiltin(lookupBuiltinMethod(node.getName()), *self,
+                                 arg ? &*arg : nullptr, wraps),
+                     node);
+}
+
+std::shared_ptr<Expression> ConstantFolder::foldBinaryOp(BinaryOpEXP &node) {
+  auto left = operandValue(node.left);
+  auto right = operandValue(node.right);
+  if (!left || !right)
+    return nullptr;
+  return makeLiteral(evalBinary(node.op, *left, *right, wraps), node);
+}
+
+std::shared_ptr<Expression> ConstantFolder::foldUnaryOp(UnaryOpEXP &node) {
+  auto operand = operandValue(node.operand);
+  if (!operand)
+    return nullptr;
+  return makeLiteral(evalUnary(node.op, *operand, wraps), node);
+}
+
+std::shared_ptr<Expression>
+ConstantFolder::foldConversion(ConversionEXP &node) {
+  auto from = operandValue(node.from);
+  if (!from || !node.to)
+    return nullptr;
+  return makeLiteral(evalConversion(*from, *node.to), node);
+}
+
+std::shared_ptr<Expression> ConstantFolder::foldCall(Expression &node,
+                                                     bool allowArray) {
+  if (!interpreter)
+    return nullptr;
+  auto value = interpreter->evaluate(node, currentScope);
+  if (!value || (value->kind == ConstValue::CV_ARRAY && !allowArray))
+    return nullptr;
+  return makeLiteral(value, node);
+}
+
+std::shared_ptr<Expression>
+ConstantFolder::fold(const std::shared_ptr<Expression> &expr) {
+  if (!expr)
+    return expr;
+
+  std::shared_ptr<Expression> folded;
+  switch (expr->getKind()) {
+  case E_Var_Reference: {
+    if (auto it = constants.find(declOf(expr->getName()));
+        it != constants.end())
+      return copyLiteral(*it->second);
+  } break;
+  case E_Method_Call: {
+    auto call = std::static_pointer_cast<MethodCallEXP>(expr);
+    // user methods take `left` as an object, keep it
+    if (isBuiltinCall(*call))
+      call->left = fold(call->left);
+    for (auto &arg : call->arguments)
+      arg = fold(arg);
+    folded = foldMethodCall(*call);
+    if (!folded)
+      folded = foldCall(*call, false);
+  } break;
+  case E_Function_Call: {
+    auto call = std::static_pointer_cast<FuncCallEXP>(expr);
+    for (auto &arg : call->arguments)
+      arg = fold(arg);
+    folded = foldCall(*call, false);
+  } break;
+  case E_Constructor_Call: {
+    auto call = std::static_pointer_cast<ConstructorCallEXP>(expr);
+    for (auto &arg : call->arguments)
+      arg = fold(arg);
+  } break;
+  case E_Binary_Operator: {
+    auto op = std::static_pointer_cast<BinaryOpEXP>(expr);
+    op->left = fold(op->left);
+    op->right = fold(op->right);
+    folded = foldBinaryOp(*op);
+  } break;
+  case E_Unary_Operator: {
+    auto op = std::static_pointer_cast<UnaryOpEXP>(expr);
+    op->operand = fold(op->operand);
+    folded = foldUnaryOp(*op);
+  } break;
+  case E_Conversion: {
+    auto conversion = std::static_pointer_cast<ConversionEXP>(expr);
+    conversion->from = fold(conversion->from);
+    folded = foldConversion(*conversion);
+  } break;
+  case E_Element_Reference: {
+    auto element = std::static_pointer_cast<ElementRefEXP>(expr);
+    element->index = fold(element->index);
+  } break;
+  case E_Array_Literal: {
+    auto array = std::static_pointer_cast<ArrayLiteralExpr>(expr);
+    for (auto &element : array->elements)
+      element = fold(element);
+  } break;
+  case E_Assignment_Wrapper: {
+    auto wrapper = std::static_pointer_cast<AssignmentWrapperEXP>(expr);
+    foldEntity(wrapper->assignment);
+  } break;
+  default:
+    break;
+  }
+
+  return folded ? folded : expr;
+}
+
+//========== BODIES ==========
+
+const Entity *ConstantFolder::declOf(const std::string &name) {
+  auto symbol = currentScope->getSymbol(name);
+  return symbol ? symbol->decl.get() : nullptr;
+}
+
+void ConstantFolder::foldBody(Decl &decl) {
+  std::shared_ptr<Block> body;
+  std::shared_ptr<Scope<Entity>> scope;
+  if (auto method = dynamic_cast<MethodDecl *>(&decl)) {
+    body = method->body;
+    scope = method->scope;
+  } else if (auto constr = dynamic_cast<ConstrDecl *>(&decl)) {
+    body = constr->body;
+    scope = constr->scope;
+  } else if (auto func = dynamic_cast<FuncDecl *>(&decl)) {
+    body = func->body;
+    scope = func->scope;
+  }
+  if (!body || !scope)
+    return;
+
+  auto enclosingScope = currentScope;
+  currentScope = scope;
+  collectAssigned(body);
+  foldBlock(body);
+  currentScope = enclosingScope;
+}
+
+void ConstantFolder::foldBlock(const std::shared_ptr<Block> &block) {
+  if (!block)
+    return;
+  for (auto &part : block->parts) {
+    if (auto expr = std::dynamic_pointer_cast<Expression>(part))
+      part = fold(expr);
+    else
+      foldEntity(part);
+  }
+}
+
+void ConstantFolder::foldEntity(const std::shared_ptr<Entity> &entity) {
+  if (!entity)
+    return;
+
+  auto enclosingScope = currentScope;
+  switch (entity->getKind()) {
+  case E_Block:
+    foldBlock(std::static_pointer_cast<Block>(entity));
+    break;
+  case E_Variable_Decl: {
+    auto var = std::static_pointer_cast<VarDecl>(entity);
+    var->initializer = fold(var->initializer);
+    if (var->initializer && var->type && var->type->kind == TYPE_ARRAY) {
+      if (auto array = foldCall(*var->initializer, true))
+        var->initializer = array;
+    }
+    // only a literal of exactly the declared type is propagated
+    if (var->initializer && isLiteral(*var->initializer) &&
+        var->initializer->type == var->type &&
+        !assigned.contains(var.get()))
+      constants[var.get()] = var->initializer;
+  } break;
+  case E_Assignment: {
+    auto assignment = std::static_pointer_cast<AssignmentSTMT>(entity);
+    if (assignment->element)
+      assignment->element->index = fold(assignment->element->index);
+    assignment->expression = fold(assignment->expression);
+  } break;
+  case E_Return_Statement: {
+    auto ret = std::static_pointer_cast<ReturnSTMT>(entity);
+    ret->expr = fold(ret->expr);
+  } break;
+  case E_If_Statement: {
+    auto ifStmt = std::static_pointer_cast<IfSTMT>(entity);
+    if (ifStmt->scope) currentScope = ifStmt->scope;
+    ifStmt->condition = fold(ifStmt->condition);
+    foldBlock(ifStmt->ifTrue);
+    foldEntity(ifStmt->ifFalse);
+  } break;
+  case E_While_Loop: {
+    auto whileStmt = std::static_pointer_cast<WhileSTMT>(entity);
+    if (whileStmt->scope) currentScope = whileStmt->scope;
+    whileStmt->condition = fold(whileStmt->condition);
+    foldBlock(whileStmt->body);
+  } break;
+  case E_For_Loop: {
+    auto forStmt = std::static_pointer_cast<ForSTMT>(entity);
+    if (forStmt->scope) currentScope = forStmt->scope;
+    forStmt->condition = fold(forStmt->condition);
+    foldEntity(forStmt->post);
+    foldBlock(forStmt->body);
+  } break;
+  case E_Switch_Statement: {
+    auto switchStmt = std::static_pointer_cast<SwitchSTMT>(entity);
+    switchStmt->condition = fold(switchStmt->condition);
+    for (const auto &caseStmt : switchStmt->cases) {
+      if (!caseStmt)
+        continue;
+      foldBlock(caseStmt->body);
+    }
+  } break;
+  default:
+    break;
+  }
+  currentScope = enclosingScope;
+}
+
+void ConstantFolder::collectAssigned(const std::shared_ptr<Entity> &entity) {
+  if (!entity)
+    return;
+
+  auto enclosingScope = currentScope;
+  switch (entity->getKind()) {
+  case E_Block:
+    for (const auto &part : std::static_pointer_cast<Block>(entity)->parts)
+      collectAssigned(part);
+    break;
+  case E_Variable_Decl:
+    collectAssigned(std::static_pointer_cast<VarDecl>(entity)->initializer);
+    break;
+  case E_Assignment: {
+    auto assignment = std::static_pointer_cast<AssignmentSTMT>(entity);
+    if (assignment->variable)
+      assigned.insert(declOf(assignment->variable->getName()));
+    collectAssigned(assignment->expression);
+  } break;
+  case E_Return_Statement:
+    collectAssigned(std::static_pointer_cast<ReturnSTMT>(entity)->expr);
+    break;
+  case E_If_Statement: {
+    auto ifStmt = std::static_pointer_cast<IfSTMT>(entity);
+    if (ifStmt->scope) currentScope = ifStmt->scope;
+    collectAssigned(ifStmt->condition);
+    collectAssigned(ifStmt->ifTrue);
+    collectAssigned(ifStmt->ifFalse);
+  } break;
+  case E_While_Loop: {
+    auto whileStmt = std::static_pointer_cast<WhileSTMT>(entity);
+    if (whileStmt->scope) currentScope = whileStmt->scope;
+    collectAssigned(whileStmt->condition);
+    collectAssigned(whileStmt->body);
+  } break;
+  case E_For_Loop: {
+    auto forStmt = std::static_pointer_cast<ForSTMT>(entity);
+    if (forStmt->scope) currentScope = forStmt->scope;
+    if (forStmt->varWithAss)
+      assigned.insert(declOf(forStmt->varWithAss->getName()));
+    collectAssigned(forStmt->condition);
+    collectAssigned(forStmt->post);
+    collectAssigned(forStmt->body);
+  } break;
+  case E_Switch_Statement: {
+    auto switchStmt = std::static_pointer_cast<SwitchSTMT>(entity);
+    collectAssigned(switchStmt->condition);
+    for (const auto &caseStmt : switchStmt->cases) {
+      if (!caseStmt)
+        continue;
+      collectAssigned(caseStmt->body);
+    }
+  } break;
+  // assignments may hide inside of expressions
+  case E_Assignment_Wrapper:
+    collectAssigned(
+        std::static_pointer_cast<AssignmentWrapperEXP>(entity)->assignment);
+    break;
+  case E_Method_Call: {
+    auto call = std::static_pointer_cast<MethodCallEXP>(entity);
+    collectAssigned(call->left);
+    for (const auto &arg : call->arguments)
+      collectAssigned(arg);
+  } break;
+  case E_Function_Call:
+    for (const auto &arg : std::static_pointer_cast<FuncCallEXP>(entity)->arguments)
+      collectAssigned(arg);
+    break;
+  case E_Constructor_Call:
+    for (const auto &arg :
+         std::static_pointer_cast<ConstructorCallEXP>(entity)->arguments)
+      collectAssigned(arg);
+    break;
+  case E_Binary_Operator: {
+    auto op = std::static_pointer_cast<BinaryOpEXP>(entity);
+    collectAssigned(op->left);
+    collectAssigned(op->right);
+  } break;
+  case E_Unary_Operator:
+    collectAssigned(std::static_pointer_cast<UnaryOpEXP>(entity)->operand);
+    break;
+  case E_Conversion:
+    collectAssigned(std::static_pointer_cast<ConversionEXP>(entity)->from);
+    break;
+  default:
+    break;
+  }
+  currentScope = enclosingScope;
+}
@@ -0,0 +1,467 @@
+#include "frontend/semantic/EscapeAnalysis.h"
+#include "frontend/types/Builtins.h"
+
+#include <deque>
+
+EscapeAnalysis::EscapeAnalysis(const ModuleDecl &module,
+                               const ClassHierarchy *hierarchy)
+    : module(module), hierarchy(hierarchy) {
+  for (const auto &child : module.children) {
+    switch (child->getKind()) {
+    case E_Function_Decl:
+    case E_Main_Decl: {
+      auto func = std::static_pointer_cast<FuncDecl>(child);
+      if (func->body && func->scope)
+        callees[func.get()] = {&func->args, func->scope};
+    } break;
+    case E_Class_Decl:
+      for (const auto &decl : std::static_pointer_cast<ClassDecl>(child)->methods) {
+        // inherited copies are resolved to a base method
+        if (auto method = std::dynamic_pointer_cast<MethodDecl>(decl)) {
+          if (!method->isInherited && method->body && method->scope)
+            callees[method.get()] = {&method->args, method->scope};
+        } else if (auto constr = std::dynamic_pointer_cast<ConstrDecl>(decl)) {
+          if (constr->body && constr->scope)
+            callees[constr.get()] = {&constr->args, constr->scope};
+        }
+      }
+      break;
+    case E_Variable_Decl:
+      globals.insert(child.get());
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+void EscapeAnalysis::analyze() {
+  for (const auto &child : module.children) {
+    switch (child->getKind()) {
+    // lives as long as a program does
+    case E_Variable_Decl:
+      currentScope = module.scope;
+      use(std::static_pointer_cast<VarDecl>(child)->initializer,
+          {Sink::SINK_ESCAPE});
+      break;
+    case E_Function_Decl:
+    case E_Main_Decl: {
+      auto func = std::static_pointer_cast<FuncDecl>(child);
+      walkBody(func->body, func->scope, func->signature);
+    } break;
+    case E_Class_Decl:
+      for (const auto &decl : std::static_pointer_cast<ClassDecl>(child)->methods) {
+        if (auto method = std::dynamic_pointer_cast<MethodDecl>(decl)) {
+          if (!method->isInherited)
+            walkBody(method->body, method->scope, method->signature);
+        } else if (auto constr = std::dynamic_pointer_cast<ConstrDecl>(decl)) {
+          walkBody(constr->body, constr->scope, constr->signature);
+        }
+      }
+      break;
+    default:
+      break;
+    }
+  }
+  currentScope = nullptr;
+
+  propagate();
+  for (auto object : objects)
+    object->escapes = escaping.contains(object);
+}
+
+//========== NAMES ==========
+
+const Entity *EscapeAnalysis::declOf(const std::string &name) {
+  auto symbol = currentScope->getSymbol(name);
+  return symbol ? symbol->decl.get() : nullptr;
+}
+
+const ClassDecl *EscapeAnalysis::classOf(const std::string &name) {
+  auto decl = declOf(name);
+  if (!decl || decl->getKind() != E_Class_Decl)
+    return nullptr;
+  return static_cast<const ClassDecl *>(decl);
+}
+
+const Decl *EscapeAnalysis::methodOf(const MethodCallEXP &call) {
+  if (!call.left)
+    return nullptr;
+
+  std::string className;
+  if (call.left->getKind() == E_Class_Name) {
+    className = call.left->getName();
+  } else if (auto type = call.left->type) {
+    if (type->kind == TYPE_ACCESS)
+      type = std::static_pointer_cast<TypeAccess>(type)->to;
+    if (!type || type->kind != TYPE_CLASS)
+      return nullptr;
+    className = type->name;
+  }
+
+  auto classDecl = classOf(className);
+  if (!classDecl)
+    return nullptr;
+  auto mangled = className + "_" + call.getName();
+  for (const auto &candidate : classDecl->methods) {
+    if (candidate->getName() != mangled)
+      continue;
+    const Decl *callee = candidate.get();
+    if (auto method = std::dynamic_pointer_cast<MethodDecl>(candidate))
+      callee = &method->implementation();
+    if (callees.contains(callee))
+      return callee;
+  }
+  return nullptr;
+}
+
+std::vector<const Decl *>
+EscapeAnalysis::overridersOf(const MethodCallEXP &call) {
+  if (call.vtableIndex < 0 || !call.left || !call.left->type)
+    return {};
+  auto type = call.left->type;
+  if (type->kind == TYPE_ACCESS)
+    type = std::static_pointer_cast<TypeAccess>(type)->to;
+  auto classDecl = type && hierarchy ? hierarchy->classOf(type->name) : nullptr;
+  // unknown, nullptr is a callee we can not see
+  if (!classDecl)
+    return {nullptr};
+
+  std::vector<const Decl *> result;
+  for (auto method : hierarchy->implementations(*classDecl, call.vtableIndex))
+    result.push_back(&method->implementation());
+  return result;
+}
+
+// same name codegen calls, Class_Create + names of argument types
+const Decl *EscapeAnalysis::constructorOf(const ConstructorCallEXP &call) {
+  auto classDecl = classOf(call.left->getName());
+  if (!classDecl)
+    return nullptr;
+  auto mangled = call.left->getName() + "_Create";
+  for (const auto &arg : call.arguments) {
+    if (!arg || !arg->type)
+      return nullptr;
+    mangled += arg->type->name;
+  }
+  for (const auto &candidate : classDecl->methods) {
+    if (candidate->getName() == mangled && callees.contains(candidate.get()))
+      return candidate.get();
+  }
+  return nullptr;
+}
+
+// no constructor at all, nothing runs but an allocation
+bool EscapeAnalysis::isDefault(const ConstructorCallEXP &call) {
+  auto classDecl = classOf(call.left->getName());
+  if (!classDecl || !call.arguments.empty())
+    return false;
+  for (const auto &candidate : classDecl->methods) {
+    if (candidate->getKind() == E_Constructor_Decl)
+      return false;
+  }
+  return true;
+}
+
+bool EscapeAnalysis::isLocal(const Entity *decl) const {
+  if (!decl || globals.contains(decl))
+    return false;
+  return decl->getKind() == E_Variable_Decl ||
+         decl->getKind() == E_Parameter_Decl;
+}
+
+// holds a pointer to an object, not the object
+bool EscapeAnalysis::isReference(const Type *type) {
+  return type->kind == TYPE_ACCESS || type->kind == TYPE_STRING;
+}
+
+const Type *EscapeAnalysis::declaredType(const Entity *decl) {
+  switch (decl->getKind()) {
+  case E_Variable_Decl:
+    return static_cast<const VarDecl *>(decl)->type.get();
+  case E_Parameter_Decl:
+    return static_cast<const ParameterDecl *>(decl)->type.get();
+  default:
+    return nullptr;
+  }
+}
+
+//========== SINKS ==========
+
+EscapeAnalysis::Sink EscapeAnalysis::storeTo(const Type *type) {
+  if (!type || isReference(type))
+    return {Sink::SINK_ESCAPE};
+  return {Sink::SINK_COPY};
+}
+
+// parameter as its body sees it, or unknown
+EscapeAnalysis::Sink EscapeAnalysis::paramOf(const Decl *callee,
+                                             size_t index) const {
+  auto it = callee ? callees.find(callee) : callees.end();
+  if (it == callees.end() || index >= it->second.args->size())
+    return {Sink::SINK_ESCAPE};
+  const auto &param = (*it->second.args)[index];
+  auto symbol = it->second.scope->getSymbol(param->getName());
+  if (!symbol || !symbol->decl)
+    return {Sink::SINK_ESCAPE};
+  return {Sink::SINK_FLOW, symbol->decl.get()};
+}
+
+void EscapeAnalysis::flow(const Entity *from, Sink sink, bool byValue) {
+  switch (sink.kind) {
+  case Sink::SINK_DISCARD:
+  case Sink::SINK_COPY:
+    return;
+  case Sink::SINK_ESCAPE:
+    escaping.insert(from);
+    return;
+  case Sink::SINK_FLOW: {
+    auto type = declaredType(sink.to);
+    bool isPointer = !type || isReference(type);
+    // var b : Point := a, a copy
+    if (byValue && !isPointer && sink.to->getKind() == E_Variable_Decl)
+      return;
+    // one slot per call site, see header
+    if (loopDepth > 0 && isPointer && sink.to->getKind() == E_Variable_Decl &&
+        (byValue || from->getKind() == E_Constructor_Call))
+      escaping.insert(from);
+    sources[sink.to].push_back(from);
+  } return;
+  }
+}
+
+//========== WALK ==========
+
+void EscapeAnalysis::walkBody(const std::shared_ptr<Block> &body,
+                              const std::shared_ptr<Scope<Entity>> &scope,
+                              const std::shared_ptr<TypeFunc> &signature) {
+  if (!body || !scope)
+    return;
+  currentScope = scope;
+  returnType = signature && !signature->isVoid ? signature->return_type
+                                               : nullptr;
+  loopDepth = 0;
+  walk(body);
+}
+
+void EscapeAnalysis::walk(const std::shared_ptr<Entity> &entity) {
+  if (!entity)
+    return;
+
+  auto enclosingScope = currentScope;
+  switch (entity->getKind()) {
+  case E_Block:
+    for (const auto &part : std::static_pointer_cast<Block>(entity)->parts)
+      walk(part);
+    break;
+  case E_Variable_Decl: {
+    auto var = std::static_pointer_cast<VarDecl>(entity);
+    use(var->initializer, {Sink::SINK_FLOW, var.get()});
+  } break;
+  case E_Assignment: {
+    auto assignment = std::static_pointer_cast<AssignmentSTMT>(entity);
+    Sink sink{Sink::SINK_ESCAPE};
+    if (assignment->variable) {
+      auto decl = declOf(assignment->variable->getName());
+      if (isLocal(decl))
+        sink = {Sink::SINK_FLOW, decl};
+      else if (decl)
+        sink = storeTo(declaredType(decl));
+    } else if (assignment->field) {
+      sink = storeTo(assignment->field->type.get());
+    } else if (assignment->element) {
+      use(assignment->element->index, {Sink::SINK_DISCARD});
+      sink = storeTo(assignment->element->type.get());
+    }
+    use(assignment->expression, sink);
+  } break;
+  case E_Return_Statement:
+    use(std::static_pointer_cast<ReturnSTMT>(entity)->expr,
+        storeTo(returnType.get()));
+    break;
+  case E_If_Statement: {
+    auto ifStmt = std::static_pointer_cast<IfSTMT>(entity);
+    if (ifStmt->scope) currentScope = ifStmt->scope;
+    use(ifStmt->condition, {Sink::SINK_DISCARD});
+    walk(ifStmt->ifTrue);
+    walk(ifStmt->ifFalse);
+  } break;
+  case E_Switch_Statement: {
+    auto switchStmt = std::static_pointer_cast<SwitchSTMT>(entity);
+    use(switchStmt->condition, {Sink::SINK_DISCARD});
+    for (const auto &caseStmt : switchStmt->cases)
+      if (caseStmt)
+        walk(caseStmt->body);
+  } break;
+  case E_While_Loop: {
+    auto whileStmt = std::static_pointer_cast<WhileSTMT>(entity);
+    if (whileStmt->scope) currentScope = whileStmt->scope;
+    loopDepth++;
+    use(whileStmt->condition, {Sink::SINK_DISCARD});
+    walk(whileStmt->body);
+    loopDepth--;
+  } break;
+  case E_For_Loop: {
+    auto forStmt = std::static_pointer_cast<ForSTMT>(entity);
+    if (forStmt->scope) currentScope = forStmt->scope;
+    loopDepth++;
+    use(forStmt->condition, {Sink::SINK_DISCARD});
+    walk(forStmt->post);
+    walk(forStmt->body);
+    loopDepth--;
+  } break;
+  default:
+    if (auto expr = std::dynamic_pointer_cast<Expression>(entity))
+      use(expr, {Sink::SINK_DISCARD});
+    break;
+  }
+  currentScope = enclosingScope;
+}
+
+void EscapeAnalysis::use(const std::shared_ptr<Expression> &expr, Sink sink) {
+  if (!expr)
+    return;
+
+  switch (expr->getKind()) {
+  case E_Constructor_Call: {
+    auto call = std::static_pointer_cast<ConstructorCallEXP>(expr);
+    objects.push_back(call.get());
+    flow(call.get(), sink, false);
+
+    // String(other) copies bytes of other
+    if (call->type && call->type->kind == TYPE_STRING) {
+      for (const auto &arg : call->arguments)
+        use(arg, {Sink::SINK_DISCARD});
+      break;
+    }
+
+    // a body of a constructor sees an object as `this`,
+    // one we can not see may keep it
+    auto constr = constructorOf(*call);
+    if (constr)
+      flow(call.get(), paramOf(constr, 0), false);
+    else if (!isDefault(*call))
+      flow(call.get(), {Sink::SINK_ESCAPE}, false);
+    arguments(call->arguments, constr, 1);
+  } break;
+  case E_Var_Reference: {
+    auto decl = declOf(expr->getName());
+    if (!isLocal(decl))
+      break;
+    auto type = declaredType(decl);
+    flow(decl, sink, type && !isReference(type));
+  } break;
+  case E_This:
+    if (auto decl = declOf(expr->getName()))
+      flow(decl, sink, false);
+    break;
+  case E_Element_Reference:
+    use(std::static_pointer_cast<ElementRefEXP>(expr)->index,
+        {Sink::SINK_DISCARD});
+    break;
+  case E_Method_Call: {
+    auto call = std::static_pointer_cast<MethodCallEXP>(expr);
+    if (isBuiltinCall(*call)) {
+      // s.Append(x) is s itself, so chains of them are
+      auto method = lookupBuiltinMethod(call->getName());
+      bool isSelf = method == BM_APPEND || method == BM_PUSH;
+      use(call->left, isSelf ? sink : Sink{Sink::SINK_DISCARD});
+      for (const auto &arg : call->arguments)
+        use(arg, {Sink::SINK_DISCARD});
+      break;
+    }
+    // methods take `this` first
+    if (auto overriders = overridersOf(*call); !overriders.empty()) {
+      passed(call->left, overriders, 0);
+      for (size_t i = 0; i < call->arguments.size(); i++)
+        passed(call->arguments[i], overriders, i + 1);
+      break;
+    }
+    auto callee = methodOf(*call);
+    if (call->left && call->left->getKind() != E_Class_Name)
+      use(call->left, paramOf(callee, 0));
+    arguments(call->arguments, callee, 1);
+  } break;
+  case E_Function_Call: {
+    auto call = std::static_pointer_cast<FuncCallEXP>(expr);
+    auto decl = declOf(call->getName());
+    const Decl *callee = decl && decl->getKind() == E_Function_Decl
+                             ? static_cast<const Decl *>(decl)
+                             : nullptr;
+    // the builtin printf reads bytes of a String while it runs
+    if (callee && !callees.contains(callee) && call->getName() == "printf") {
+      for (const auto &arg : call->arguments)
+        use(arg, {Sink::SINK_DISCARD});
+      break;
+    }
+    arguments(call->arguments, callee, 0);
+  } break;
+  case E_Assignment_Wrapper:
+    walk(std::static_pointer_cast<AssignmentWrapperEXP>(expr)->assignment);
+    break;
+  case E_Binary_Operator: {
+    auto op = std::static_pointer_cast<BinaryOpEXP>(expr);
+    use(op->left, {Sink::SINK_DISCARD});
+    use(op->right, {Sink::SINK_DISCARD});
+  } break;
+  case E_Unary_Operator:
+    use(std::static_pointer_cast<UnaryOpEXP>(expr)->operand,
+        {Sink::SINK_DISCARD});
+    break;
+  // the last part is a whole chain, see Parser::parseMemberAccess
+  case E_Chained_Functions: {
+    const auto &parts = std::static_pointer_cast<CompoundEXP>(expr)->parts;
+    if (!parts.empty())
+      use(parts.back(), sink);
+  } break;
+  // anything we do not follow
+  case E_Conversion:
+    use(std::static_pointer_cast<ConversionEXP>(expr)->from,
+        {Sink::SINK_ESCAPE});
+    break;
+  case E_Array_Literal:
+    for (const auto &element :
+         std::static_pointer_cast<ArrayLiteralExpr>(expr)->elements)
+      use(element, {Sink::SINK_ESCAPE});
+    break;
+  // literals, fields, names...
+  default:
+    break;
+  }
+}
+
+void EscapeAnalysis::arguments(
+    const std::vector<std::shared_ptr<Expression>> &args, const Decl *callee,
+    size_t firstParam) {
+  for (size_t i = 0; i < args.size(); i++)
+    use(args[i], paramOf(callee, firstParam + i));
+}
+
+// a node of an expression joins parameters of all callees
+void EscapeAnalysis::passed(const std::shared_ptr<Expression> &value,
+                            const std::vector<const Decl *> &callees,
+                            size_t param) {
+  if (!value)
+    return;
+  use(value, {Sink::SINK_FLOW, value.get()});
+  for (auto callee : callees)
+    flow(value.get(), paramOf(callee, param), false);
+}
+
+//========== PROPAGATION ==========
+
+// whatever flows into an escaping node escapes too
+void EscapeAnalysis::propagate() {
+  std::deque<const Entity *> worklist(escaping.begin(), escaping.end());
+  while (!worklist.empty()) {
+    auto node = worklist.front();
+    worklist.pop_front();
+    auto it = sources.find(node);
+    if (it == sources.end())
+      continue;
+    for (auto source : it->second) {
+      if (escaping.insert(source).second)
+        worklist.push_back(source);
+    }
+  }
+}
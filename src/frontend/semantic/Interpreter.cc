@@ -0,0 +1,538 @@
+#include "frontend/semantic/Interpreter.h"
+#include "frontend/types/Builtins.h"
+
+#include <cstring>
+
+namespace {
+
+void appendKey(std::string &key, const ConstValue &value) {
+  char buffer[sizeof(int64_t) + sizeof(double)];
+  std::memcpy(buffer, &value.i, sizeof(int64_t));
+  std::memcpy(buffer + sizeof(int64_t), &value.r, sizeof(double));
+  key += static_cast<char>(value.kind);
+  key += static_cast<char>(value.bits);
+  key += static_cast<char>(value.b);
+  key.append(buffer, sizeof(buffer));
+  for (const auto &element : value.elements)
+    appendKey(key, element);
+  key += '\0';
+}
+
+} // namespace
+
+Interpreter::Interpreter(const ModuleDecl &module, bool wraps) : wraps(wraps) {
+  auto addFunction = [this](const Decl *decl,
+                            const std::vector<std::shared_ptr<ParameterDecl>> &args,
+                            const std::shared_ptr<Block> &body,
+                            const std::shared_ptr<Scope<Entity>> &scope,
+                            const std::shared_ptr<TypeFunc> &signature,
+                            size_t firstArg) {
+    if (!body || !scope || !signature || signature->isVoid ||
+        !signature->return_type || args.size() < firstArg)
+      return;
+    functions[decl] = {&args, firstArg, body, scope, signature->return_type};
+  };
+
+  for (const auto &child : module.children) {
+    switch (child->getKind()) {
+    case E_Function_Decl: {
+      auto func = std::static_pointer_cast<FuncDecl>(child);
+      addFunction(func.get(), func->args, func->body, func->scope,
+                  func->signature, 0);
+    } break;
+    case E_Class_Decl: {
+      for (const auto &decl : std::static_pointer_cast<ClassDecl>(child)->methods) {
+        auto method = std::dynamic_pointer_cast<MethodDecl>(decl);
+        // methods take `this` first, static ones just never read it
+        if (method && method->isStatic && !method->isInherited)
+          addFunction(method.get(), method->args, method->body, method->scope,
+                      method->signature, 1);
+      }
+    } break;
+    case E_Variable_Decl:
+      globals.insert(child.get());
+      break;
+    default:
+      break;
+    }
+  }
+
+  findPure();
+}
+
+//========== NAMES ==========
+
+const Entity *Interpreter::declOf(const std::string &name) {
+  auto symbol = currentScope->getSymbol(name);
+  return symbol ? symbol->decl.get() : nullptr;
+}
+
+const Decl *Interpreter::calleeOf(const Expression &call) {
+  if (call.getKind() == E_Function_Call) {
+    auto decl = declOf(call.getName());
+    if (!decl || decl->getKind() != E_Function_Decl)
+      return nullptr;
+    return static_cast<const Decl *>(decl);
+  }
+
+  // Class::method(...)
+  if (call.getKind() == E_Method_Call) {
+    auto &method = static_cast<const MethodCallEXP &>(call);
+    if (!method.left || method.left->getKind() != E_Class_Name)
+      return nullptr;
+    auto decl = declOf(method.left->getName());
+    if (!decl || decl->getKind() != E_Class_Decl)
+      return nullptr;
+    auto mangled = method.left->getName() + "_" + method.getName();
+    for (const auto &candidate : static_cast<const ClassDecl *>(decl)->methods) {
+      if (candidate->getName() != mangled)
+        continue;
+      // inherited -> one of a base class
+      const Decl *callee = candidate.get();
+      if (auto method = std::dynamic_pointer_cast<MethodDecl>(candidate))
+        callee = &method->implementation();
+      if (functions.contains(callee))
+        return callee;
+    }
+  }
+
+  return nullptr;
+}
+
+const Type *Interpreter::declaredType(const Entity *decl) {
+  switch (decl->getKind()) {
+  case E_Variable_Decl:
+    return static_cast<const VarDecl *>(decl)->type.get();
+  case E_Parameter_Decl:
+    return static_cast<const ParameterDecl *>(decl)->type.get();
+  default:
+    return nullptr;
+  }
+}
+
+//========== PURITY ==========
+
+// every candidate is pure until it is shown otherwise,
+// repeated until nothing changes, so cycles of calls
+// stay pure unless some member of a cycle is not
+void Interpreter::findPure() {
+  for (const auto &[decl, _] : functions)
+    pure.insert(decl);
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (const auto &[decl, function] : functions) {
+      if (!pure.contains(decl))
+        continue;
+      currentScope = function.scope;
+      if (!isPure(function.body)) {
+        pure.erase(decl);
+        changed = true;
+      }
+    }
+  }
+  currentScope = nullptr;
+}
+
+bool Interpreter::isLocal(const std::string &name) {
+  auto decl = declOf(name);
+  if (!decl || globals.contains(decl))
+    return false;
+  return decl->getKind() == E_Variable_Decl ||
+         decl->getKind() == E_Parameter_Decl;
+}
+
+bool Interpreter::isPure(const std::shared_ptr<Entity> &entity) {
+  if (!entity)
+    return true;
+
+  auto enclosingScope = currentScope;
+  bool result = false;
+  switch (entity->getKind()) {
+  case E_Block:
+    result = true;
+    for (const auto &part : std::static_pointer_cast<Block>(entity)->parts)
+      result = result && isPure(part);
+    break;
+  case E_Variable_Decl:
+    result = isPure(std::static_pointer_cast<VarDecl>(entity)->initializer);
+    break;
+  case E_Assignment: {
+    auto assignment = std::static_pointer_cast<AssignmentSTMT>(entity);
+    if (assignment->variable)
+      result = isLocal(assignment->variable->getName());
+    else if (assignment->element)
+      result = isPure(assignment->element);
+    result = result && isPure(assignment->expression);
+  } break;
+  // `arr[i] := x` is parsed as an expression
+  case E_Assignment_Wrapper:
+    result = isPure(
+        std::static_pointer_cast<AssignmentWrapperEXP>(entity)->assignment);
+    break;
+  case E_Return_Statement:
+    result = isPure(std::static_pointer_cast<ReturnSTMT>(entity)->expr);
+    break;
+  case E_If_Statement: {
+    auto ifStmt = std::static_pointer_cast<IfSTMT>(entity);
+    if (ifStmt->scope) currentScope = ifStmt->scope;
+    result = isPure(ifStmt->condition) && isPure(ifStmt->ifTrue) &&
+             isPure(ifStmt->ifFalse);
+  } break;
+  case E_While_Loop: {
+    auto whileStmt = std::static_pointer_cast<WhileSTMT>(entity);
+    if (whileStmt->scope) currentScope = whileStmt->scope;
+    result = isPure(whileStmt->condition) && isPure(whileStmt->body);
+  } break;
+  case E_For_Loop: {
+    auto forStmt = std::static_pointer_cast<ForSTMT>(entity);
+    if (forStmt->scope) currentScope = forStmt->scope;
+    result = forStmt->varWithAss && isLocal(forStmt->varWithAss->getName()) &&
+             forStmt->condition && forStmt->post && isPure(forStmt->condition) &&
+             isPure(forStmt->post) && isPure(forStmt->body);
+  } break;
+  case E_Integer_Literal:
+  case E_Real_Literal:
+  case E_Boolean_Literal:
+    result = true;
+    break;
+  case E_Array_Literal:
+    result = true;
+    for (const auto &element :
+         std::static_pointer_cast<ArrayLiteralExpr>(entity)->elements)
+      result = result && isPure(element);
+    break;
+  case E_Var_Reference:
+    result = isLocal(entity->getName());
+    break;
+  case E_Element_Reference: {
+    auto element = std::static_pointer_cast<ElementRefEXP>(entity);
+    result = element->arr && isLocal(element->arr->getName()) &&
+             isPure(element->index);
+  } break;
+  case E_Method_Call: {
+    auto call = std::static_pointer_cast<MethodCallEXP>(entity);
+    if (auto callee = calleeOf(*call))
+      result = pure.contains(callee);
+    else
+      // a String is in the runtime, never a ConstValue
+      result = isBuiltinCall(*call) &&
+               call->left->type->kind != TYPE_STRING &&
+               lookupBuiltinMethod(call->getName()) != BM_SIZE &&
+               isPure(call->left);
+    for (const auto &arg : call->arguments)
+      result = result && isPure(arg);
+  } break;
+  case E_Function_Call: {
+    auto call = std::static_pointer_cast<FuncCallEXP>(entity);
+    auto callee = calleeOf(*call);
+    result = callee && pure.contains(callee);
+    for (const auto &arg : call->arguments)
+      result = result && isPure(arg);
+  } break;
+  case E_Binary_Operator: {
+    auto op = std::static_pointer_cast<BinaryOpEXP>(entity);
+    result = isPure(op->left) && isPure(op->right);
+  } break;
+  case E_Unary_Operator:
+    result = isPure(std::static_pointer_cast<UnaryOpEXP>(entity)->operand);
+    break;
+  case E_Conversion:
+    result = isPure(std::static_pointer_cast<ConversionEXP>(entity)->from);
+    break;
+  // strings, objects, fields, `this`, switch...
+  default:
+    result = false;
+    break;
+  }
+  currentScope = enclosingScope;
+  return result;
+}
+
+//========== EVALUATION ==========
+
+std::optional<ConstValue>
+Interpreter::evaluate(const Expression &call,
+                      const std::shared_ptr<Scope<Entity>> &scope) {
+  currentScope = scope;
+  auto callee = calleeOf(call);
+  if (!callee || !pure.contains(callee))
+    return std::nullopt;
+
+  const auto &arguments =
+      call.getKind() == E_Function_Call
+          ? static_cast<const FuncCallEXP &>(call).arguments
+          : static_cast<const MethodCallEXP &>(call).arguments;
+  std::vector<ConstValue> args;
+  for (const auto &arg : arguments) {
+    auto value = arg ? literalValue(*arg) : std::nullopt;
+    if (!value)
+      return std::nullopt;
+    args.push_back(*value);
+  }
+
+  steps = 0;
+  depth = 0;
+  std::optional<ConstValue> result;
+  try {
+    result = this->call(callee, args);
+  } catch (const GiveUp &) {
+    result = std::nullopt;
+  }
+  currentScope = nullptr;
+  locals = nullptr;
+  return result;
+}
+
+ConstValue Interpreter::expect(const std::optional<ConstValue> &value) {
+  if (!value)
+    throw GiveUp{};
+  return *value;
+}
+
+void Interpreter::step() {
+  if (++steps > maxSteps)
+    throw GiveUp{};
+}
+
+ConstValue Interpreter::call(const Decl *callee,
+                             const std::vector<ConstValue> &args) {
+  const auto &function = functions.at(callee);
+  if (args.size() + function.firstArg != function.args->size() ||
+      depth >= maxDepth)
+    throw GiveUp{};
+
+  std::string key(reinterpret_cast<const char *>(&callee), sizeof(callee));
+  for (const auto &arg : args)
+    appendKey(key, arg);
+  if (auto it = memo.find(key); it != memo.end())
+    return it->second;
+
+  auto callerScope = currentScope;
+  auto callerLocals = locals;
+  std::unordered_map<const Entity *, ConstValue> frame;
+  currentScope = function.scope;
+  locals = &frame;
+  depth++;
+
+  for (size_t i = 0; i < args.size(); i++) {
+    const auto &param = (*function.args)[function.firstArg + i];
+    auto decl = declOf(param->getName());
+    if (!decl || !param->type)
+      throw GiveUp{};
+    frame[decl] = expect(coerce(args[i], *param->type));
+  }
+
+  if (execBlock(function.body) != FLOW_RETURN)
+    throw GiveUp{};
+  auto result = expect(coerce(returned, *function.returnType));
+
+  depth--;
+  locals = callerLocals;
+  currentScope = callerScope;
+
+  memo[key] = result;
+  return result;
+}
+
+Interpreter::Flow Interpreter::execBlock(const std::shared_ptr<Block> &block) {
+  if (!block)
+    return FLOW_NEXT;
+  for (const auto &part : block->parts) {
+    if (exec(part) == FLOW_RETURN)
+      return FLOW_RETURN;
+  }
+  return FLOW_NEXT;
+}
+
+Interpreter::Flow Interpreter::exec(const std::shared_ptr<Entity> &entity) {
+  step();
+  if (!entity)
+    return FLOW_NEXT;
+
+  if (entity->getKind() == E_Assignment_Wrapper)
+    return exec(
+        std::static_pointer_cast<AssignmentWrapperEXP>(entity)->assignment);
+
+  if (auto expr = std::dynamic_pointer_cast<Expression>(entity)) {
+    eval(expr);
+    return FLOW_NEXT;
+  }
+
+  auto enclosingScope = currentScope;
+  auto flow = FLOW_NEXT;
+  switch (entity->getKind()) {
+  case E_Block:
+    flow = execBlock(std::static_pointer_cast<Block>(entity));
+    break;
+  case E_Variable_Decl: {
+    auto var = std::static_pointer_cast<VarDecl>(entity);
+    if (!var->type)
+      throw GiveUp{};
+    ConstValue value;
+    if (var->initializer) {
+      value = expect(coerce(eval(var->initializer), *var->type));
+    } else if (var->type->kind == TYPE_ARRAY) {
+      auto array = std::static_pointer_cast<TypeArray>(var->type);
+      if (array->size == 0)
+        throw GiveUp{};
+      value = ConstValue::ofArray(std::vector<ConstValue>(array->size));
+    }
+    (*locals)[declOf(var->getName())] = value;
+  } break;
+  case E_Assignment: {
+    auto assignment = std::static_pointer_cast<AssignmentSTMT>(entity);
+    auto value = eval(assignment->expression);
+    if (assignment->variable) {
+      auto decl = declOf(assignment->variable->getName());
+      auto type = decl ? declaredType(decl) : nullptr;
+      if (!type || !locals->contains(decl))
+        throw GiveUp{};
+      (*locals)[decl] = expect(coerce(value, *type));
+    } else if (assignment->element) {
+      auto &element = elementOf(*assignment->element);
+      auto array = dynamic_cast<const TypeArray *>(
+          declaredType(declOf(assignment->element->arr->getName())));
+      if (!array || !array->el_type)
+        throw GiveUp{};
+      element = expect(coerce(value, *array->el_type));
+    } else {
+      throw GiveUp{};
+    }
+  } break;
+  case E_Return_Statement: {
+    auto ret = std::static_pointer_cast<ReturnSTMT>(entity);
+    if (!ret->expr)
+      throw GiveUp{};
+    returned = eval(ret->expr);
+    flow = FLOW_RETURN;
+  } break;
+  case E_If_Statement: {
+    auto ifStmt = std::static_pointer_cast<IfSTMT>(entity);
+    if (ifStmt->scope) currentScope = ifStmt->scope;
+    auto condition = eval(ifStmt->condition);
+    if (condition.kind != ConstValue::CV_BOOL)
+      throw GiveUp{};
+    flow = condition.b ? execBlock(ifStmt->ifTrue) : exec(ifStmt->ifFalse);
+  } break;
+  case E_While_Loop: {
+    auto whileStmt = std::static_pointer_cast<WhileSTMT>(entity);
+    if (whileStmt->scope) currentScope = whileStmt->scope;
+    for (;;) {
+      auto condition = eval(whileStmt->condition);
+      if (condition.kind != ConstValue::CV_BOOL)
+        throw GiveUp{};
+      if (!condition.b)
+        break;
+      if ((flow = execBlock(whileStmt->body)) == FLOW_RETURN)
+        break;
+    }
+  } break;
+  // condition, body, then post, as codegen lowers it (emitLoop)
+  case E_For_Loop: {
+    auto forStmt = std::static_pointer_cast<ForSTMT>(entity);
+    if (forStmt->scope) currentScope = forStmt->scope;
+    for (;;) {
+      auto condition = eval(forStmt->condition);
+      if (condition.kind != ConstValue::CV_BOOL)
+        throw GiveUp{};
+      if (!condition.b)
+        break;
+      if ((flow = execBlock(forStmt->body)) == FLOW_RETURN)
+        break;
+      exec(forStmt->post);
+    }
+  } break;
+  default:
+    throw GiveUp{};
+  }
+  currentScope = enclosingScope;
+  return flow;
+}
+
+ConstValue &Interpreter::localOf(const std::string &name) {
+  auto it = locals->find(declOf(name));
+  if (it == locals->end())
+    throw GiveUp{};
+  return it->second;
+}
+
+ConstValue &Interpreter::elementOf(const ElementRefEXP &element) {
+  auto index = eval(element.index);
+  auto &array = localOf(element.arr->getName());
+  if (index.kind != ConstValue::CV_INT || array.kind != ConstValue::CV_ARRAY ||
+      index.i < 0 || static_cast<uint64_t>(index.i) >= array.elements.size())
+    throw GiveUp{};
+  return array.elements[index.i];
+}
+
+ConstValue Interpreter::eval(const std::shared_ptr<Expression> &expr) {
+  step();
+  if (!expr)
+    throw GiveUp{};
+
+  ConstValue value;
+  switch (expr->getKind()) {
+  case E_Integer_Literal:
+  case E_Real_Literal:
+  case E_Boolean_Literal:
+  case E_Array_Literal:
+    value = expect(literalValue(*expr));
+    break;
+  case E_Var_Reference:
+    value = localOf(expr->getName());
+    break;
+  case E_Element_Reference:
+    value = elementOf(*std::static_pointer_cast<ElementRefEXP>(expr));
+    break;
+  case E_Method_Call: {
+    auto call = std::static_pointer_cast<MethodCallEXP>(expr);
+    std::vector<ConstValue> args;
+    for (const auto &arg : call->arguments)
+      args.push_back(eval(arg));
+    if (auto callee = calleeOf(*call)) {
+      value = this->call(callee, args);
+      break;
+    }
+    if (!isBuiltinCall(*call) || args.size() > 1)
+      throw GiveUp{};
+    auto self = eval(call->left);
+    value = expect(evalBuiltin(lookupBuiltinMethod(call->getName()), self,
+                               args.empty() ? nullptr : &args[0], wraps));
+  } break;
+  case E_Function_Call: {
+    auto call = std::static_pointer_cast<FuncCallEXP>(expr);
+    auto callee = calleeOf(*call);
+    if (!callee || !pure.contains(callee))
+      throw GiveUp{};
+    std::vector<ConstValue> args;
+    for (const auto &arg : call->arguments)
+      args.push_back(eval(arg));
+    value = this->call(callee, args);
+  } break;
+  case E_Binary_Operator: {
+    auto op = std::static_pointer_cast<BinaryOpEXP>(expr);
+    auto left = eval(op->left);
+    auto right = eval(op->right);
+    value = expect(evalBinary(op->op, left, right, wraps));
+  } break;
+  case E_Unary_Operator: {
+    auto op = std::static_pointer_cast<UnaryOpEXP>(expr);
+    value = expect(evalUnary(op->op, eval(op->operand), wraps));
+  } break;
+  case E_Conversion: {
+    auto conversion = std::static_pointer_cast<ConversionEXP>(expr);
+    if (!conversion->to)
+      throw GiveUp{};
+    value = expect(evalConversion(eval(conversion->from), *conversion->to));
+  } break;
+  default:
+    throw GiveUp{};
+  }
+
+  // reading a local that was never written
+  if (value.kind == ConstValue::CV_UNSET)
+    throw GiveUp{};
+  return value;
+}
@@ -1,159 +1,551 @@
 #include "frontend/semantic/SemanticAnalyzer.h"
-#include "frontend/parser/Expression.h"
-#include <iostream>
+#include "frontend/semantic/ConstantFolder.h"
+#include "frontend/semantic/EscapeAnalysis.h"
+#include "util/ThreadPool.h"
 
-/*
-bool SemanticAnalyzer::analyze(std::shared_ptr<Entity> root) {
-  currentScope = symbolTable->getGlobalScope();
-  checkEntity(root);
+#include <algorithm>
+#include <set>
+
+namespace {
+
+// builtins that lower to an LLVM integer
+bool isInteger(const Type &type) {
+  switch (type.kind) {
+  case TYPE_BYTE:
+  case TYPE_INT:
+  case TYPE_I16:
+  case TYPE_I64:
+  case TYPE_U16:
+  case TYPE_U32:
+  case TYPE_U64:
+    return true;
+  default:
+    return false;
+  }
+}
+
+} // namespace
+
+bool SemanticAnalyzer::analyze(const std::shared_ptr<ModuleDecl> &module) {
+  if (!module) return false;
+  module->accept(*this);
   return errors.empty();
 }
 
-void SemanticAnalyzer::checkEntity(const std::shared_ptr<Entity> &entity) {
-  switch (entity->getKind()) {
-  case E_Block:
-    checkBlock(std::dynamic_pointer_cast<Block>(entity));
-    break;
-  case E_Method_Call:
-    checkMethodCall(std::dynamic_pointer_cast<MethodCallEXP>(entity));
-    break;
-  // case E_Assignment:
-  //     checkAssignment(std::dynamic_pointer_cast<AssignmentSTMT>(entity));
-  //     break;
-  // case E_Variable_Decl:
-  //     checkVariableDecl(std::dynamic_pointer_cast<VarDecl>(entity));
-  //     break;
-  // ...
-  default:
-    break;
+void SemanticAnalyzer::annotate(Expression &expr) {
+  expr.resolvedType(*moduleTypes, currentScope);
+}
+
+void SemanticAnalyzer::markModified(const std::string &name) {
+  // bodies are analyzed in parallel, a module variable
+  // is shared by them, so only scopes of a body are seen
+  for (auto scope = currentScope; scope && scope->getKind() != SCOPE_MODULE;
+       scope = scope->prevScope()) {
+    auto &symbols = scope->getSymbols();
+    if (auto it = symbols.find(name); it != symbols.end()) {
+      if (it->second.decl && it->second.decl->getKind() == E_Variable_Decl)
+        std::static_pointer_cast<VarDecl>(it->second.decl)->isModified = true;
+      return;
+    }
   }
 }
 
-void SemanticAnalyzer::checkBlock(const std::shared_ptr<Block> &block) {
-  for (const auto &part : block->parts) {
-    checkEntity(part);
+void SemanticAnalyzer::reportError(const std::string &message) {
+  // printed by a caller, see getErrors
+  errors.push_back("[Semantic Error] " + message);
+}
+
+//========== PHASES ==========
+
+void SemanticAnalyzer::visit(ModuleDecl &node) {
+  currentScope = node.scope; // global scope -> module scope
+  // scope has the full dotted name of a module
+  moduleTypes = &globalTypeTable->types[currentScope->getName()];
+
+  checkSignatures(node);
+  analyzeInitializers(node);
+  analyzeBodies(node);
+  evaluateCalls(node);
+  findEscapes(node);
+}
+
+void SemanticAnalyzer::checkSignature(
+    const std::string &name,
+    const std::vector<std::shared_ptr<ParameterDecl>> &args,
+    const std::shared_ptr<TypeFunc> &signature) {
+  for (const auto &arg : args) {
+    if (!arg->type)
+      reportError("Unknown type of parameter '" + arg->getName() + "' in '" +
+                  name + "'");
   }
+  if (signature && !signature->isVoid && !signature->return_type)
+    reportError("Unknown return type of '" + name + "'");
 }
 
-void SemanticAnalyzer::checkMethodCall(
-    const std::shared_ptr<MethodCallEXP> &methodCall) {
-  // Проверка типа объекта
-  resolveType(methodCall->left);
-  auto objType = methodCall->left->resolveType(globalTypeTable->builtinTypes);
-  if (!objType) {
-    reportError("Undefined object in method call", methodCall->getLoc());
-    return;
+// class layout ones (see ClassLayout), soa of arrays,
+// fast-math flags of bodies (see CodegenOptions)
+void SemanticAnalyzer::checkAttributes(const Decl &decl) {
+  for (const auto &attr : decl.attributes) {
+    bool known = false;
+    switch (decl.getKind()) {
+    case E_Class_Decl:
+      known = attr.name == "reorder" || attr.name == "packed" ||
+              attr.name == "align";
+      break;
+    case E_Variable_Decl:
+      known = attr.name == "soa";
+      break;
+    case E_Function_Decl:
+    case E_Method_Decl:
+    case E_Constructor_Decl:
+      known = attr.name == "fast_math" || attr.name == "reassoc" ||
+              attr.name == "contract" || attr.name == "nnan" ||
+              attr.name == "ninf";
+      break;
+    default:
+      break;
+    }
+
+    if (!known) {
+      reportError("Unknown attribute '" + attr.name + "' of '" +
+                  decl.getName() + "'");
+    } else if (attr.name == "align") {
+      if (!attr.value || *attr.value <= 0 || (*attr.value & (*attr.value - 1)))
+        reportError("align of '" + decl.getName() +
+                    "' must be a power of two");
+    } else if (attr.value) {
+      reportError("Attribute '" + attr.name + "' of '" + decl.getName() +
+                  "' takes no value");
+    }
   }
 
-  // Поиск метода в классе
-  auto type = globalTypeTable->getType("", objType->name);
-  if (!type) {
-    reportError("Type '" + objType->name + "' not found", methodCall->getLoc());
-    return;
+  // a field of each element in an array of its own
+  if (decl.getKind() == E_Variable_Decl && decl.attribute("soa")) {
+    auto &var = static_cast<const VarDecl &>(decl);
+    auto array = var.type && var.type->kind == TYPE_ARRAY
+                     ? std::static_pointer_cast<TypeArray>(var.type)
+                     : nullptr;
+    if (!array || !array->el_type || array->el_type->kind != TYPE_CLASS)
+      reportError("soa '" + decl.getName() + "' is not an array of a class");
+    else if (var.initializer)
+      reportError("soa array '" + decl.getName() +
+                  "' can not have an initializer");
+  }
+
+  // a base is a prefix, its offsets can not change
+  if (decl.getKind() == E_Class_Decl) {
+    auto &classDecl = static_cast<const ClassDecl &>(decl);
+    if (classDecl.attribute("packed") && classDecl.base_class &&
+        !classDecl.base_class->attribute("packed"))
+      reportError("Packed class '" + decl.getName() +
+                  "' extends not packed '" +
+                  classDecl.base_class->getName() + "'");
+  }
+}
+
+// [unroll], [unroll(N)], [nounroll], [vectorize], [vectorize(W)],
+// [novectorize], [interleave(N)], see CodeGenVisitor::loopHints
+void SemanticAnalyzer::checkLoopHints(const Attributes &hints) {
+  auto has = [&](const char *name) {
+    return std::ranges::any_of(
+        hints, [&](const Attribute &hint) { return hint.name == name; });
+  };
+  for (const auto &hint : hints) {
+    if (hint.name == "unroll" || hint.name == "vectorize" ||
+        hint.name == "interleave") {
+      if (hint.value && *hint.value <= 0)
+        reportError("Loop hint '" + hint.name + "' takes a positive count");
+      else if (!hint.value && hint.name == "interleave")
+        reportError("Loop hint 'interleave' takes a count");
+      else if (hint.value && hint.name == "vectorize" &&
+               (*hint.value & (*hint.value - 1)))
+        reportError("Vectorize width must be a power of two");
+    } else if (hint.name == "nounroll" || hint.name == "novectorize") {
+      if (hint.value)
+        reportError("Loop hint '" + hint.name + "' takes no value");
+    } else {
+      reportError("Unknown loop hint '" + hint.name + "'");
+    }
+  }
+
+  if (has("unroll") && has("nounroll"))
+    reportError("Loop is both unrolled and not");
+  if (has("vectorize") && has("novectorize"))
+    reportError("Loop is both vectorized and not");
+}
+
+void SemanticAnalyzer::checkSignatures(ModuleDecl &module) {
+  // every module is parsed by now, see main.cc
+  hierarchy = std::make_shared<ClassHierarchy>(symbolTable->getGlobalScope());
+  for (const auto &error : hierarchy->check(module))
+    reportError(error);
+
+  for (const auto &child : module.children) {
+    // variables are checked once visited
+    if (auto decl = std::dynamic_pointer_cast<Decl>(child);
+        decl && decl->getKind() != E_Variable_Decl)
+      checkAttributes(*decl);
+
+    if (auto classDecl = std::dynamic_pointer_cast<ClassDecl>(child)) {
+      for (const auto &field : classDecl->fields) {
+        if (!field->type)
+          reportError("Unknown type of field '" + field->getName() +
+                      "' in class '" + classDecl->getName() + "'");
+      }
+      for (const auto &decl : classDecl->methods) {
+        auto method = std::dynamic_pointer_cast<MethodDecl>(decl);
+        // an inherited copy is checked on a base
+        if (!method || !method->isInherited)
+          checkAttributes(*decl);
+        if (method)
+          checkSignature(method->getName(), method->args, method->signature);
+        else if (auto constr = std::dynamic_pointer_cast<ConstrDecl>(decl))
+          checkSignature(constr->getName(), constr->args, constr->signature);
+      }
+    } else if (auto func = std::dynamic_pointer_cast<FuncDecl>(child)) {
+      checkSignature(func->getName(), func->args, func->signature);
+    } else if (auto var = std::dynamic_pointer_cast<VarDecl>(child)) {
+      if (!var->type)
+        reportError("Unknown type of variable '" + var->getName() + "'");
+    }
   }
+}
 
-  // Приведение к TypeClass
-  auto classType = std::dynamic_pointer_cast<TypeClass>(type);
-  if (!classType) {
-    reportError("Type '" + objType->name + "' is not a class",
-                methodCall->getLoc());
+void SemanticAnalyzer::analyzeInitializers(ModuleDecl &module) {
+  ConstantFolder folder(*moduleTypes, currentScope, nullptr, wrapsOverflow);
+  for (const auto &child : module.children) {
+    if (child->getKind() != E_Variable_Decl)
+      continue;
+    auto var = std::static_pointer_cast<VarDecl>(child);
+    var->accept(*this);
+    var->initializer = folder.fold(var->initializer);
+  }
+}
+
+void SemanticAnalyzer::analyzeBodies(ModuleDecl &module) {
+  std::vector<std::shared_ptr<Decl>> bodies;
+  for (const auto &child : module.children) {
+    if (auto classDecl = std::dynamic_pointer_cast<ClassDecl>(child)) {
+      for (const auto &decl : classDecl->methods) {
+        // inherited copies share a body with the base method
+        if (auto method = std::dynamic_pointer_cast<MethodDecl>(decl);
+            method && method->isInherited)
+          continue;
+        bodies.push_back(decl);
+      }
+    } else if (child->getKind() == E_Function_Decl ||
+               child->getKind() == E_Main_Decl) {
+      bodies.push_back(std::static_pointer_cast<Decl>(child));
+    }
+  }
+
+  // types first, then folding reads them, errors of a worker
+  // are kept per body and joined in order of bodies
+  std::vector<std::vector<std::string>> bodyErrors(bodies.size());
+  auto analyzeBody = [&, this](size_t index) {
+    SemanticAnalyzer worker(globalTypeTable, symbolTable, wrapsOverflow);
+    worker.moduleTypes = moduleTypes;
+    worker.hierarchy = hierarchy;
+    worker.currentScope = currentScope;
+    bodies[index]->accept(worker);
+    ConstantFolder(*moduleTypes, currentScope, nullptr, wrapsOverflow)
+        .foldBody(*bodies[index]);
+    bodyErrors[index] = std::move(worker.errors);
+  };
+
+  if (bodies.size() < 2) {
+    for (size_t index = 0; index < bodies.size(); index++)
+      analyzeBody(index);
+  } else {
+    ThreadPool pool(std::min(ThreadPool::defaultWorkers(), bodies.size()));
+    for (size_t index = 0; index < bodies.size(); index++) {
+      pool.submit([&analyzeBody, index] { analyzeBody(index); });
+    }
+    pool.wait();
+  }
+
+  for (auto &body : bodyErrors)
+    errors.insert(errors.end(), std::make_move_iterator(body.begin()),
+                  std::make_move_iterator(body.end()));
+}
+
+void SemanticAnalyzer::evaluateCalls(ModuleDecl &module) {
+  Interpreter interpreter(module, wrapsOverflow);
+  if (!interpreter.hasPureFunctions())
     return;
+
+  // folded once more, now with pure calls evaluated,
+  // on one thread, evaluation reads bodies of others
+  ConstantFolder folder(*moduleTypes, currentScope, &interpreter,
+                        wrapsOverflow);
+  for (const auto &child : module.children) {
+    switch (child->getKind()) {
+    case E_Variable_Decl: {
+      auto var = std::static_pointer_cast<VarDecl>(child);
+      var->initializer = folder.fold(var->initializer);
+    } break;
+    case E_Function_Decl:
+    case E_Main_Decl:
+      ConstantFolder(*moduleTypes, currentScope, &interpreter, wrapsOverflow)
+          .foldBody(*std::static_pointer_cast<Decl>(child));
+      break;
+    case E_Class_Decl:
+      for (const auto &decl :
+           std::static_pointer_cast<ClassDecl>(child)->methods) {
+        if (auto method = std::dynamic_pointer_cast<MethodDecl>(decl);
+            method && method->isInherited)
+          continue;
+        ConstantFolder(*moduleTypes, currentScope, &interpreter, wrapsOverflow)
+            .foldBody(*decl);
+      }
+      break;
+    default:
+      break;
+    }
   }
+}
 
-  // Поиск метода
-  auto method = classType->getMethod(methodCall->method_name);
-  if (!method) {
-    reportError("Method '" + methodCall->method_name + "' not found in type '" +
-                    objType->name + "'",
-                methodCall->getLoc());
+// on final bodies, folding may drop calls
+void SemanticAnalyzer::findEscapes(ModuleDecl &module) {
+  EscapeAnalysis(module, hierarchy.get()).analyze();
+}
+
+//========== DECLARATIONS ==========
+
+void SemanticAnalyzer::visit(ClassDecl &node) {
+  inScope(node.scope, [&] {
+    for (auto &method : node.methods) {
+      method->accept(*this);
+    }
+  });
+}
+
+void SemanticAnalyzer::visit(MethodDecl &node) {
+  if (!node.body) return; // builtin or forward
+  inScope(node.scope, [&] { node.body->accept(*this); });
+}
+
+void SemanticAnalyzer::visit(ConstrDecl &node) {
+  if (!node.body) return;
+  inScope(node.scope, [&] { node.body->accept(*this); });
+}
+
+void SemanticAnalyzer::visit(FuncDecl &node) {
+  if (!node.body) return;
+  inScope(node.scope, [&] { node.body->accept(*this); });
+}
+
+void SemanticAnalyzer::visit(VarDecl &node) {
+  checkAttributes(node);
+  if (node.initializer) node.initializer->accept(*this);
+}
+
+//========== STATEMENTS ==========
+
+void SemanticAnalyzer::visit(AssignmentSTMT &node) {
+  if (node.variable) node.variable->accept(*this);
+  if (node.field) node.field->accept(*this);
+  if (node.element) node.element->accept(*this);
+  if (node.expression) node.expression->accept(*this);
+
+  // arr := ..., arr[i] := ..., arr[i].x := ...
+  if (node.variable)
+    markModified(node.variable->getName());
+  if (node.element && node.element->arr)
+    markModified(node.element->arr->getName());
+  if (node.field && node.field->el && node.field->el->arr)
+    markModified(node.field->el->arr->getName());
+}
+
+void SemanticAnalyzer::visit(ReturnSTMT &node) {
+  if (node.expr) node.expr->accept(*this);
+}
+
+void SemanticAnalyzer::visit(IfSTMT &node) {
+  inScope(node.scope, [&] {
+    node.condition->accept(*this);
+    if (node.ifTrue) node.ifTrue->accept(*this);
+    if (node.ifFalse) node.ifFalse->accept(*this);
+  });
+}
+
+void SemanticAnalyzer::visit(EnumRefEXP &node) {
+  auto symbol = currentScope->getSymbol(node.enumName);
+  if (!symbol || !symbol->decl || symbol->decl->getKind() != E_Enum_Decl)
+    reportError("Unknown enum '" + node.enumName + "'");
+  else if (!std::static_pointer_cast<EnumDecl>(symbol->decl)
+                ->items.contains(node.itemName))
+    reportError("Unknown item '" + node.itemName + "' of enum '" +
+                node.enumName + "'");
+  annotate(node);
+}
+
+void SemanticAnalyzer::visit(CaseSTMT &node) {
+  if (node.condition_literal) node.condition_literal->accept(*this);
+  if (node.body) node.body->accept(*this);
+}
+
+// labels are distinct constants, so a switch
+// lowers to one LLVM switch (see CodeGenVisitor)
+void SemanticAnalyzer::visit(SwitchSTMT &node) {
+  node.condition->accept(*this);
+  if (auto type = node.condition->type; type && !isInteger(*type))
+    reportError("Switch subject must be an integer, not '" + type->name + "'");
+  std::set<int64_t> labels;
+  bool hasDefault = false;
+  for (const auto &caseStmt : node.cases) {
+    if (!caseStmt)
+      continue;
+    caseStmt->accept(*this);
+    if (caseStmt->isDefault) {
+      if (hasDefault)
+        reportError("Switch has more than one default");
+      hasDefault = true;
+      continue;
+    }
+
+    // an unknown enum item is reported by visit(EnumRefEXP)
+    auto label = labelOf(*caseStmt->condition_literal);
+    if (!label && caseStmt->condition_literal->getKind() != E_Enum_Reference)
+      reportError("Case label '" + caseStmt->condition_literal->getName() +
+                  "' is not an integer constant");
+    else if (label && !labels.insert(*label).second)
+      reportError("Duplicate case label " + std::to_string(*label));
+  }
+}
+
+std::optional<int64_t> SemanticAnalyzer::labelOf(const Expression &label) {
+  if (label.getKind() == E_Integer_Literal)
+    return static_cast<const IntLiteralEXP &>(label).getValue();
+  if (label.getKind() != E_Enum_Reference)
+    return std::nullopt;
+
+  auto &item = static_cast<const EnumRefEXP &>(label);
+  auto symbol = currentScope->getSymbol(item.enumName);
+  if (!symbol || !symbol->decl || symbol->decl->getKind() != E_Enum_Decl)
+    return std::nullopt;
+  auto &items = std::static_pointer_cast<EnumDecl>(symbol->decl)->items;
+  if (auto it = items.find(item.itemName); it != items.end())
+    return it->second;
+  return std::nullopt;
+}
+
+void SemanticAnalyzer::visit(WhileSTMT &node) {
+  checkLoopHints(node.hints);
+  inScope(node.scope, [&] {
+    node.condition->accept(*this);
+    if (node.body) node.body->accept(*this);
+  });
+}
+
+void SemanticAnalyzer::visit(ForSTMT &node) {
+  checkLoopHints(node.hints);
+  inScope(node.scope, [&] {
+    if (node.varWithAss) node.varWithAss->accept(*this);
+    if (node.condition) node.condition->accept(*this);
+    if (node.post) node.post->accept(*this);
+    if (node.body) node.body->accept(*this);
+  });
+}
+
+//========== EXPRESSIONS ==========
+// children first, so that resolving a node
+// only reads types cached on its operands
+
+void SemanticAnalyzer::visit(ArrayLiteralExpr &node) {
+  for (const auto &element : node.elements) {
+    element->accept(*this);
+  }
+  annotate(node);
+}
+
+void SemanticAnalyzer::visit(FieldRefEXP &node) {
+  if (node.obj) node.obj->accept(*this);
+  if (node.el) node.el->accept(*this);
+  annotate(node);
+}
+
+void SemanticAnalyzer::visit(VarRefEXP &node) {
+  annotate(node);
+
+  // fields of a soa array are apart, there
+  // is no element to pass or copy as a whole
+  if (&node == indexedArray || !node.type || node.type->kind != TYPE_ARRAY)
     return;
+  // passed, copied or called a method of, may be written
+  markModified(node.getName());
+  auto decl = currentScope->lookup(node.getName());
+  if (decl && decl->getKind() == E_Variable_Decl &&
+      std::static_pointer_cast<VarDecl>(decl)->attribute("soa"))
+    reportError("soa array '" + node.getName() + "' can only be indexed");
+}
+
+void SemanticAnalyzer::visit(ElementRefEXP &node) {
+  indexedArray = node.arr.get();
+  if (node.arr) node.arr->accept(*this);
+  if (node.index) node.index->accept(*this);
+  annotate(node);
+}
+
+void SemanticAnalyzer::visit(MethodCallEXP &node) {
+  if (node.left) node.left->accept(*this);
+  for (const auto &arg : node.arguments) {
+    arg->accept(*this);
   }
+  annotate(node);
 
-  // Проверка аргументов
-  if (method->args.size() != methodCall->arguments.size()) {
-    reportError("Argument count mismatch for method '" +
-                    methodCall->method_name + "'",
-                methodCall->getLoc());
+  // a receiver may be of any class below its static one
+  if (!hierarchy || !node.left || !node.left->type ||
+      node.left->getKind() == E_Class_Name)
+    return;
+  auto type = node.left->type;
+  if (type->kind == TYPE_ACCESS)
+    type = std::static_pointer_cast<TypeAccess>(type)->to;
+  if (!type || type->kind != TYPE_CLASS)
     return;
+  if (auto classDecl = hierarchy->classOf(type->name))
+    node.vtableIndex = hierarchy->dispatch(*classDecl, node.getName());
+}
+
+void SemanticAnalyzer::visit(FuncCallEXP &node) {
+  for (const auto &arg : node.arguments) {
+    arg->accept(*this);
   }
+  annotate(node);
+}
 
-  for (size_t i = 0; i < methodCall->arguments.size(); ++i) {
-    resolveType(methodCall->arguments[i]);
-    auto argType =
-        methodCall->arguments[i]->resolveType(globalTypeTable->builtinTypes);
-    if (argType != method->args[i]) {
-      reportError("Type mismatch in argument " + std::to_string(i + 1),
-                  methodCall->arguments[i]->getLoc());
-    }
+void SemanticAnalyzer::visit(ConstructorCallEXP &node) {
+  node.left->accept(*this);
+  for (const auto &arg : node.arguments) {
+    arg->accept(*this);
+  }
+  annotate(node);
+}
+
+void SemanticAnalyzer::visit(CompoundEXP &node) {
+  for (const auto &part : node.parts) {
+    part->accept(*this);
   }
+  annotate(node);
 }
 
-void SemanticAnalyzer::resolveType(const std::shared_ptr<Expression> &expr) {
-  auto type = expr->resolveType(globalTypeTable->builtinTypes);
-  if (!type) {
-    reportError("Cannot resolve type of expression", expr->getLoc());
-  }
-}
-
-void SemanticAnalyzer::reportError(const std::string &message, const Loc &loc) {
-  errors.push_back("[Semantic Error] " + message +
-                   " (Line: " + std::to_string(loc.line) +
-                   ", Col: " + std::to_string(loc.col) + ")");
-  std::cerr << errors.back() << std::endl;
-} */
-
-// void SemanticAnalyzer::checkAssignment(const std::shared_ptr<AssignmentSTMT>&
-// assignment) {
-//     // Проверка типа переменной
-//     if (assignment->variable) {
-//         resolveType(assignment->variable);
-//         auto varType =
-//         assignment->variable->resolveType(globalTypeTable->builtinTypes);
-//         resolveType(assignment->expression);
-//         auto exprType =
-//         assignment->expression->resolveType(globalTypeTable->builtinTypes);
-//         if (varType != exprType) {
-//             reportError("Type mismatch in assignment", assignment->getLoc());
-//         }
-//     } else if (assignment->field) {
-//         // Проверка поля класса
-//         resolveType(assignment->field->obj);
-//         auto objType =
-//         assignment->field->obj->resolveType(globalTypeTable->builtinTypes);
-//         auto classType = std::dynamic_pointer_cast<TypeClass>(objType);
-//         if (classType) {
-//             auto fieldDecl =
-//             classType->getField(assignment->field->field_name); if
-//             (!fieldDecl) {
-//                 reportError("Field '" + assignment->field->field_name + "'
-//                 not found", assignment->getLoc()); return;
-//             }
-//             resolveType(assignment->expression);
-//             auto exprType =
-//             assignment->expression->resolveType(globalTypeTable->builtinTypes);
-//             if (exprType != fieldDecl->type) {
-//                 reportError("Type mismatch in field assignment",
-//                 assignment->getLoc());
-//             }
-//         }
-//     }
-// }
-
-// void SemanticAnalyzer::checkVariableDecl(const std::shared_ptr<VarDecl>&
-// varDecl) {
-//     auto declaredType = globalTypeTable->getType("", varDecl->typeName);
-//     if (!declaredType) {
-//         reportError("Undefined type '" + varDecl->typeName + "'",
-//         varDecl->getLoc()); return;
-//     }
-
-//     if (varDecl->initializer) {
-//         resolveType(varDecl->initializer);
-//         auto initType =
-//         varDecl->initializer->resolveType(globalTypeTable->builtinTypes); if
-//         (initType != declaredType) {
-//             reportError("Variable initialization type mismatch",
-//             varDecl->getLoc());
-//         }
-//     }
-// }
\ No newline at end of file
+void SemanticAnalyzer::visit(ConversionEXP &node) {
+  node.from->accept(*this);
+  annotate(node);
+}
+
+void SemanticAnalyzer::visit(BinaryOpEXP &node) {
+  node.left->accept(*this);
+  node.right->accept(*this);
+  annotate(node);
+}
+
+void SemanticAnalyzer::visit(UnaryOpEXP &node) {
+  node.operand->accept(*this);
+  annotate(node);
+}
+
+void SemanticAnalyzer::visit(AssignmentWrapperEXP &node) {
+  node.assignment->accept(*this);
+  annotate(node);
+}
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <sstream>
 #include <stdio.h>
 #include <vector>
 
@@ -7,12 +8,64 @@
 #include "frontend/lexer/Lexer.h"
 #include "frontend/parser/Parser.h"
 #include "frontend/semantic/PrinterAst.h"
+#include "frontend/semantic/SemanticAnalyzer.h"
 
 int main(int argc, char *argv[]) {
   SourceManager sm;
   std::vector<std::string> args;
+  CodegenOptions options;
 
   for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg.starts_with("-")) {
+      if (arg == "--layout-report") {
+        options.layoutReport = true;
+      } else if (arg.starts_with("--overflow=")) {
+        auto mode = arg.substr(std::string("--overflow=").size());
+        if (mode == "wrap") {
+          options.overflow = OVERFLOW_WRAP;
+        } else if (mode == "undefined") {
+          options.overflow = OVERFLOW_UNDEFINED;
+        } else if (mode == "trap") {
+          options.overflow = OVERFLOW_TRAP;
+        } else {
+          fprintf(stderr, "Unknown overflow mode %s\n", mode.c_str());
+          return 1;
+        }
+      } else if (arg.starts_with("--allocator=")) {
+        options.allocator = arg.substr(std::string("--allocator=").size());
+        if (options.allocator.empty()) {
+          fprintf(stderr, "Empty allocator name\n");
+          return 1;
+        }
+      } else if (arg.size() == 3 && arg.starts_with("-O") &&
+                 arg[2] >= '0' && arg[2] <= '3') {
+        options.optLevel = arg[2] - '0';
+      } else if (arg == "--ffast-math") {
+        options.fastMath.fast = true;
+      } else if (arg.starts_with("--ffast-math=")) {
+        std::stringstream flags(arg.substr(arg.find('=') + 1));
+        for (std::string flag; std::getline(flags, flag, ',');) {
+          if (flag == "reassoc") {
+            options.fastMath.reassoc = true;
+          } else if (flag == "contract") {
+            options.fastMath.contract = true;
+          } else if (flag == "nnan") {
+            options.fastMath.noNaNs = true;
+          } else if (flag == "ninf") {
+            options.fastMath.noInfs = true;
+          } else {
+            fprintf(stderr, "Unknown fast-math flag %s\n", flag.c_str());
+            return 1;
+          }
+        }
+      } else {
+        fprintf(stderr, "Unknown option %s\n", argv[i]);
+        return 1;
+      }
+      continue;
+    }
+
     args.push_back(argv[i]);
     sm.addFile(argv[i]);
     printf("%s.\n", argv[i]);
@@ -21,6 +74,9 @@ int main(int argc, char *argv[]) {
   auto globalSymbolTable = std::make_shared<SymbolTable>();
   auto context = std::make_shared<llvm::LLVMContext>();
   auto globalTypeTable = std::make_shared<GlobalTypeTable>();
+  // parse every module first, so analysis sees a whole
+  // program (see ClassHierarchy), dependencies go last
+  std::vector<std::pair<std::shared_ptr<SourceBuffer>, std::shared_ptr<ModuleDecl>>> modules;
   for (int i = args.size() - 1; i >= 0; i--) {
     printf("#==== parsing %s\n", args[i].c_str());
     auto buff = std::make_shared<SourceBuffer>(sm.readSource(args[i]));
@@ -38,11 +94,22 @@ int main(int argc, char *argv[]) {
     PrinterAst printer(globalTypeTable, globalSymbolTable);
     parseTree->accept(printer);
 
-    // semantic
-    // if error -> exit(-1)
+    modules.emplace_back(buff, parseTree);
+  }
+
+  for (auto &[buff, parseTree] : modules) {
+    // semantic, codegen expects a checked tree
+    SemanticAnalyzer analyzer(globalTypeTable, globalSymbolTable,
+                              options.overflow != OVERFLOW_TRAP);
+    if (!analyzer.analyze(parseTree)) {
+      for (const auto &error : analyzer.getErrors())
+        std::cerr << error << std::endl;
+      return 1;
+    }
 
     auto global_scope = globalSymbolTable->getGlobalScope();
-    CodeGenVisitor cgvisitor(sm, buff, global_scope, globalTypeTable, context);
+    CodeGenVisitor cgvisitor(sm, buff, global_scope, parseTree->scope->getName(),
+                             globalTypeTable, context, options);
     parseTree->accept(cgvisitor);
     // cgvisitor.visitDefault(parseTree);
     cgvisitor.dumpIR();
@@ -0,0 +1,90 @@
+#include "runtime/String.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void *checked(void *memory) {
+  if (!memory) {
+    fputs("String: out of memory\n", stderr);
+    abort();
+  }
+  return memory;
+}
+
+ObwString *obw_string_new(const char *bytes, int64_t length) {
+  ObwString *string = checked(malloc(sizeof(ObwString)));
+  string->length = 0;
+  string->capacity = OBW_STRING_SMALL - 1;
+  string->data = string->small;
+  string->small[0] = '\0';
+  return obw_string_append(string, bytes, length);
+}
+
+void obw_string_reserve(ObwString *string, int64_t capacity) {
+  if (capacity <= string->capacity)
+    return;
+
+  // geometric, n appends copy O(n) bytes in total
+  int64_t grown = string->capacity * 2;
+  if (grown < capacity)
+    grown = capacity;
+
+  if (string->data == string->small) {
+    string->data = checked(malloc(grown + 1));
+    memcpy(string->data, string->small, string->length + 1);
+  } else {
+    string->data = checked(realloc(string->data, grown + 1));
+  }
+  string->capacity = grown;
+}
+
+ObwString *obw_string_append(ObwString *string, const char *bytes,
+                             int64_t length) {
+  if (length <= 0)
+    return string;
+  // s.Append(s), bytes move with a buffer they are in
+  int64_t own = -1;
+  if (bytes >= string->data && bytes < string->data + string->length)
+    own = bytes - string->data;
+  obw_string_reserve(string, string->length + length);
+  if (own >= 0)
+    bytes = string->data + own;
+  memmove(string->data + string->length, bytes, length);
+  string->length += length;
+  string->data[string->length] = '\0';
+  return string;
+}
+
+ObwString *obw_string_push(ObwString *string, char byte) {
+  return obw_string_append(string, &byte, 1);
+}
+
+ObwString *obw_string_concat(const ObwString *left, const ObwString *right) {
+  return obw_string_concat_bytes(left, right->data, right->length);
+}
+
+ObwString *obw_string_concat_bytes(const ObwString *left, const char *bytes,
+                                   int64_t length) {
+  ObwString *string = obw_string_new(NULL, 0);
+  obw_string_reserve(string, left->length + length);
+  obw_string_append(string, left->data, left->length);
+  return obw_string_append(string, bytes, length);
+}
+
+bool obw_string_equal(const ObwString *left, const ObwString *right) {
+  return obw_string_equal_bytes(left, right->data, right->length);
+}
+
+bool obw_string_equal_bytes(const ObwString *left, const char *bytes,
+                            int64_t length) {
+  return left->length == length && memcmp(left->data, bytes, length) == 0;
+}
+
+void obw_string_free(ObwString *string) {
+  if (!string)
+    return;
+  if (string->data != string->small)
+    free(string->data);
+  free(string);
+}